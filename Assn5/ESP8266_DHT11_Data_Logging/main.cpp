@@ -226,6 +226,19 @@ static void serialMenu() {
   }
 }
 
+/**
+ * -- Report presses lost because a pending-event counter was full
+ * 
+ * Printed with each event's output, and only when non-zero, so a lost
+ * button press or tilt shows up in the Serial Monitor.
+ */
+static void printDroppedEvents() {
+  uint32_t n = droppedEvents();
+  if (n == 0) return;
+  Serial.print("Events dropped (counter full): ");
+  Serial.println(n);
+}
+
 /**
  * -- System initialization and hardware setup
  * 
@@ -314,6 +327,7 @@ void loop() {
         Serial.println("Transmission failed for node 1");
       }
     }
+    printDroppedEvents();
     Serial.println("--------------------\n");
   }
 
@@ -335,6 +349,7 @@ void loop() {
         Serial.println("Transmission failed for node 2");
       }
     }
+    printDroppedEvents();
     Serial.println("------------------\n");
   }
  
@@ -2,15 +2,17 @@
 // switches.cpp
 // ============================================================================
 // Purpose: Input device detection with software debouncing
-// Features: Non-blocking polling, event flags, 50ms debounce period
+// Features: Non-blocking polling, counted events, 50ms debounce period
 // Manages: node_1 (button) and node_2 (tilt) activity counters
 // ============================================================================
 
 #include "switches.h"
 #include "config.h"
 
-static volatile bool btnEvt = false;
-static volatile bool tiltEvt = false;
+// Presses not yet taken - counted, so rapid presses are not merged
+static uint8_t btnEvt = 0;
+static uint8_t tiltEvt = 0;
+static uint32_t droppedEvt = 0;
 static uint32_t n1 = 0, n2 = 0;
 
 void switchesBegin() {
@@ -29,7 +31,8 @@ void pollSwitches() {
     tBtn = now;
     lastBtn = btn;
     if (btn == LOW) {
-      btnEvt = true;
+      if (btnEvt < 255) btnEvt++;
+      else droppedEvt++;
       Serial.println("[SW] Button pressed -> node_1");
     }
   }
@@ -40,24 +43,27 @@ void pollSwitches() {
     tTilt = now;
     lastTilt = tilt;
     if (tilt == LOW) {
-      tiltEvt = true;
+      if (tiltEvt < 255) tiltEvt++;
+      else droppedEvt++;
       Serial.println("[SW] Tilt detected -> node_2");
     }
   }
 }
 
 bool takeButtonEvent() {
-  bool e = btnEvt;
-  btnEvt = false;
-  return e;
+  if (btnEvt == 0) return false;
+  btnEvt--;
+  return true;
 }
 
 bool takeTiltEvent() {
-  bool e = tiltEvt;
-  tiltEvt = false;
-  return e;
+  if (tiltEvt == 0) return false;
+  tiltEvt--;
+  return true;
 }
 
+uint32_t droppedEvents() { return droppedEvt; }
+
 uint32_t node1Count() { return n1; }
 uint32_t node2Count() { return n2; }
 void incNode1() { n1++; }
@@ -11,8 +11,10 @@
 
 void switchesBegin();
 void pollSwitches();
+// Each call consumes one pending press (returns false when none is left)
 bool takeButtonEvent();
 bool takeTiltEvent();
+uint32_t droppedEvents();
 
 uint32_t node1Count();
 uint32_t node2Count();
@@ -0,0 +1,126 @@
+// ============================================================================
+// adc_acquire.cpp - Timer-Driven ADC Acquisition Implementation
+// ============================================================================
+// The ISR re-arms timer0 relative to its previous deadline (not "now"), so
+// interrupt latency does not accumulate into rate drift, and converts on
+// every tick - the rate does not depend on how busy loop() is.
+// analogRead() ends in system_adc_read(), which runs from flash, so it must
+// not run while the flash cache is off. The KV store brackets its flash
+// accesses with adcAcqSuspend()/adcAcqResume() (ticks in between are
+// skipped, the tick hooks still run), and net.cpp turns off the SDK's own
+// WiFi config saves (WiFi.persistent(false)).
+// Keep the rate at a few hundred Hz: reading the ESP8266 ADC much faster
+// than that starves the WiFi radio calibration.
+// ============================================================================
+
+#include "adc_acquire.h"
+#include "config.h"
+#include "logger.h"
+#include "spsc_ring.h"
+
+static SpscRing<uint16_t, ADC_RING_SIZE> ring;
+static AdcAcqStats stats = {0, 0, 0, 0, 0};
+
+static volatile uint32_t periodCycles = 0;
+static volatile uint32_t nextDeadline = 0;
+static volatile bool running = false;
+static volatile uint8_t suspendDepth = 0;   // > 0: flash busy, no conversions
+static AdcTickHook tickHooks[ADC_TICK_HOOKS];
+static volatile uint8_t tickHookCount = 0;
+
+/**
+ * timer0 compare ISR - one conversion per tick, then the tick hooks
+ */
+static void IRAM_ATTR adcTimerISR() {
+  uint32_t deadline = nextDeadline + periodCycles;
+
+  // If we fell more than a period behind (e.g. long ISR lockout), resync
+  if ((int32_t)(ESP.getCycleCount() - deadline) > 0) {
+    deadline = ESP.getCycleCount() + periodCycles;
+  }
+  nextDeadline = deadline;
+  timer0_write(deadline);
+
+  if (suspendDepth) {
+    stats.skipped++;
+  } else {
+    uint16_t v = analogRead(A0);
+    if (ring.push(v)) {
+      stats.samples++;
+      uint16_t fill = ring.size();
+      if (fill > stats.highWater) stats.highWater = fill;
+    } else {
+      stats.dropped++;
+    }
+  }
+
+  for (uint8_t i = 0, n = tickHookCount; i < n; i++) tickHooks[i]();
+}
+
+static void startTimer() {
+  noInterrupts();
+  timer0_isr_init();
+  timer0_attachInterrupt(adcTimerISR);
+  nextDeadline = ESP.getCycleCount() + periodCycles;
+  timer0_write(nextDeadline);
+  running = true;
+  interrupts();
+}
+
+static void stopTimer() {
+  noInterrupts();
+  timer0_detachInterrupt();
+  running = false;
+  interrupts();
+}
+
+void adcAcqBegin(uint16_t rateHz) {
+  if (rateHz == 0) return;
+  if (running) stopTimer();
+
+  stats.rateHz = rateHz;
+  periodCycles = ESP.getCpuFreqMHz() * 1000000UL / rateHz;
+  ring.clear();
+  startTimer();
+
+  LOGI("ADC", "A0 acquisition at %u Hz (timer0)", rateHz);
+}
+
+bool adcAcqSetRate(uint16_t rateHz) {
+  if (rateHz == 0 || rateHz == stats.rateHz) return false;
+  stats.rateHz = rateHz;
+  periodCycles = ESP.getCpuFreqMHz() * 1000000UL / rateHz;   // ISR re-arms with it
+  LOGI("ADC", "A0 acquisition at %u Hz", rateHz);
+  return true;
+}
+
+bool adcAcqRead(uint16_t& sample) {
+  return ring.pop(sample);
+}
+
+void adcAcqSuspend() {
+  suspendDepth++;
+}
+
+void adcAcqResume() {
+  if (suspendDepth) suspendDepth--;
+}
+
+bool adcAcqAddTickHook(AdcTickHook hook) {
+  for (uint8_t i = 0; i < tickHookCount; i++) {
+    if (tickHooks[i] == hook) return true;
+  }
+  if (tickHookCount >= ADC_TICK_HOOKS) {
+    LOGE("ADC", "No room for another tick hook (ADC_TICK_HOOKS)");
+    return false;
+  }
+  noInterrupts();
+  tickHooks[tickHookCount] = hook;
+  tickHookCount = tickHookCount + 1;   // Slot is filled before the ISR sees it
+  interrupts();
+  return true;
+}
+
+const AdcAcqStats& adcAcqStats() {
+  return stats;
+}
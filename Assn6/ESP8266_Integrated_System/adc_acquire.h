@@ -0,0 +1,64 @@
+// ============================================================================
+// adc_acquire.h - Timer-Driven Continuous ADC Acquisition (A0)
+// ============================================================================
+// Purpose: Sample A0 at a fixed rate from a hardware timer interrupt into a
+//          lock-free ring; filtering/calibration drain it from loop()
+// Timer: timer0 (CCOMPARE0). timer1 is owned by the analogWrite() PWM
+//        waveform generator used for the RGB LED.
+// Flash: analogRead() is not in IRAM - conversions pause while the flash
+//        cache is off (adcAcqSuspend(), see adc_acquire.cpp)
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+/**
+ * Acquisition counters
+ */
+struct AdcAcqStats {
+  uint32_t samples;     // Samples pushed into the ring
+  uint32_t dropped;     // Samples lost because the ring was full
+  uint32_t skipped;     // Ticks without a conversion (flash access)
+  uint16_t rateHz;      // Configured sample rate
+  uint16_t highWater;   // Maximum ring fill level seen
+};
+
+/**
+ * Start sampling A0 at rateHz
+ */
+void adcAcqBegin(uint16_t rateHz);
+
+/**
+ * Change the sample rate of a running acquisition (takes effect at the
+ * next tick). The input tick rides on it - call inputsRetime() after.
+ * @return true if the rate changed
+ */
+bool adcAcqSetRate(uint16_t rateHz);
+
+/**
+ * Pop one sample (consumer side, loop context)
+ * @return false if no sample is queued
+ */
+bool adcAcqRead(uint16_t& sample);
+
+/**
+ * Pause/restart conversions around flash erase/write/read, when code
+ * outside IRAM must not run from an interrupt. The timer keeps running
+ * (the tick hooks still fire); nests.
+ */
+void adcAcqSuspend();
+void adcAcqResume();
+
+/**
+ * Piggy-back a periodic job on the timer0 interrupt (one call per tick,
+ * hooks in the order added). Hooks run in ISR context: IRAM_ATTR, short,
+ * RAM data only. Adding a hook twice is a no-op.
+ * @return false if ADC_TICK_HOOKS are taken
+ */
+typedef void (*AdcTickHook)();
+bool adcAcqAddTickHook(AdcTickHook hook);
+
+/**
+ * Get acquisition counters
+ */
+const AdcAcqStats& adcAcqStats();
@@ -0,0 +1,97 @@
+// ============================================================================
+// aggregate.cpp - Streaming Windowed Aggregation Implementation
+// ============================================================================
+
+#include "aggregate.h"
+#include "config.h"
+#include "logger.h"
+#include "sampler.h"
+#include "kvstore.h"
+
+static WindowSummary current;
+static WindowSummary pending[AGG_QUEUE_SIZE];
+static uint8_t pendingHead = 0;
+static uint8_t pendingCount = 0;
+
+static uint32_t windowMs = AGG_WINDOW_MS;
+static uint32_t samplesIn = 0;
+static uint32_t windowsClosed = 0;
+static uint32_t windowsDropped = 0;
+
+static void openWindow(uint32_t now) {
+  current.windowStart = now;
+  current.windowMs = 0;
+  for (uint8_t ch = 0; ch < CH_COUNT; ch++) current.ch[ch].reset();
+}
+
+/**
+ * Sampler listener - one call per fresh channel value
+ */
+static void onSample(SensorChannel ch, float value, uint32_t /*sampledAt*/) {
+  if (ch >= CH_COUNT || isnan(value)) return;
+  current.ch[ch].add(value);
+  samplesIn++;
+}
+
+void aggBegin() {
+  windowMs = kvGetU32(KV_AGG_WINDOW_MS, AGG_WINDOW_MS);
+  openWindow(millis());
+  samplerAddListener(onSample);
+  LOGI("AGG", "Window %lu s", (unsigned long)(windowMs / 1000));
+}
+
+void aggPoll() {
+  uint32_t now = millis();
+  if (now - current.windowStart < windowMs) return;
+
+  current.windowMs = now - current.windowStart;
+
+  bool empty = true;
+  for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+    if (current.ch[ch].count) empty = false;
+  }
+
+  if (!empty) {
+    if (pendingCount == AGG_QUEUE_SIZE) {
+      // Uploader is behind - drop the oldest summary
+      pendingHead = (pendingHead + 1) % AGG_QUEUE_SIZE;
+      pendingCount--;
+      windowsDropped++;
+    }
+    pending[(pendingHead + pendingCount) % AGG_QUEUE_SIZE] = current;
+    pendingCount++;
+    windowsClosed++;
+  }
+
+  openWindow(now);
+}
+
+bool aggTakeSummary(WindowSummary& out) {
+  if (pendingCount == 0) return false;
+  out = pending[pendingHead];
+  pendingHead = (pendingHead + 1) % AGG_QUEUE_SIZE;
+  pendingCount--;
+  return true;
+}
+
+uint32_t aggWindowMs() {
+  return windowMs;
+}
+
+bool aggSetWindowMs(uint32_t ms) {
+  if (ms < AGG_WINDOW_MIN_MS) return false;
+  windowMs = ms;   // The open window closes at its new length
+  kvPutU32(KV_AGG_WINDOW_MS, ms);
+  return true;
+}
+
+void aggPrintStats() {
+  CONSOLE("\n[AGG] Aggregation statistics:\n");
+  CONSOLE("  Window:    %lu s\n", (unsigned long)(windowMs / 1000));
+  CONSOLE("  Samples:   %lu\n", (unsigned long)samplesIn);
+  CONSOLE("  Windows:   %lu (%lu dropped)\n",
+          (unsigned long)windowsClosed, (unsigned long)windowsDropped);
+  if (windowsClosed) {
+    CONSOLE("  Reduction: %.1f samples per upload\n", (float)samplesIn / windowsClosed);
+  }
+}
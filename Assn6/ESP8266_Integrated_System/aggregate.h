@@ -0,0 +1,87 @@
+// ============================================================================
+// aggregate.h - Streaming Windowed Aggregation
+// ============================================================================
+// Purpose: Summarize every sensor channel over tumbling windows so one
+//          upload replaces many raw samples
+// Method: Welford's online algorithm (numerically stable mean/variance)
+//         plus min/max per channel; fed by the sampler's sample listeners
+// Output: One WindowSummary per window, taken by the uploader in main.cpp
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include "sensors.h"
+
+/**
+ * Running statistics of one channel
+ */
+struct ChannelStats {
+  uint32_t count;
+  float mean;
+  float m2;       // Sum of squared deviations from the mean
+  float min;
+  float max;
+
+  void reset() {
+    count = 0;
+    mean = m2 = 0.0f;
+    min = INFINITY;
+    max = -INFINITY;
+  }
+
+  /**
+   * Welford update
+   */
+  void add(float x) {
+    count++;
+    float delta = x - mean;
+    mean += delta / count;
+    m2 += delta * (x - mean);
+    if (x < min) min = x;
+    if (x > max) max = x;
+  }
+
+  /**
+   * Sample standard deviation (0 for fewer than two samples)
+   */
+  float stddev() const {
+    return (count > 1) ? sqrtf(m2 / (count - 1)) : 0.0f;
+  }
+};
+
+/**
+ * Summary of one closed window
+ */
+struct WindowSummary {
+  uint32_t windowStart;   // millis() at window open
+  uint32_t windowMs;      // Actual window length
+  ChannelStats ch[CH_COUNT];
+};
+
+/**
+ * Register with the sampler and open the first window
+ */
+void aggBegin();
+
+/**
+ * Close the window when due (call every loop iteration)
+ */
+void aggPoll();
+
+/**
+ * Take the oldest closed window summary
+ * @return false if none is pending
+ */
+bool aggTakeSummary(WindowSummary& out);
+
+/**
+ * Window length (persisted in the KV store)
+ * @return false if shorter than AGG_WINDOW_MIN_MS (not applied)
+ */
+uint32_t aggWindowMs();
+bool aggSetWindowMs(uint32_t ms);
+
+/**
+ * Print window/upload counters to Serial
+ */
+void aggPrintStats();
@@ -0,0 +1,138 @@
+// ============================================================================
+// anomaly.cpp - Streaming Anomaly Detector Implementation
+// ============================================================================
+// EWMA with alpha = 2^-shift:
+//   diff = x - mean
+//   mean += alpha * diff
+//   var   = (1 - alpha) * (var + alpha * diff^2)
+// ============================================================================
+
+#include "anomaly.h"
+#include "config.h"
+#include "logger.h"
+#include "sampler.h"
+
+/**
+ * Detector tuning per channel. minStd is the sensor's noise floor - it keeps
+ * a perfectly flat signal (DHT11 steps of 1 unit) from producing huge z.
+ */
+struct ChannelTuning {
+  float minStd;
+  uint8_t alphaShift;   // Baseline time constant in samples = 2^shift
+};
+
+// Indexed by SensorChannel
+static const ChannelTuning tuning[CH_COUNT] = {
+  {0.5f, 4},            // CH_TEMPERATURE (one sample per SAMPLE_INTERVAL_MS)
+  {1.0f, 4},            // CH_HUMIDITY
+  {5.0f, 8}             // CH_LUX (sampled much faster)
+};
+static_assert(sizeof(tuning) / sizeof(tuning[0]) == CH_COUNT,
+              "One tuning entry per sensor channel");
+
+struct ChannelState {
+  float mean;
+  float var;
+  uint32_t seen;
+  bool active;
+};
+
+static ChannelState state[CH_COUNT];
+static AnomalyChannelStats chStats[CH_COUNT];
+
+static AnomalyEvent events[ANOMALY_QUEUE_SIZE];
+static uint8_t eventHead = 0;
+static uint8_t eventCount = 0;
+static uint32_t eventsDropped = 0;
+
+static void pushEvent(const AnomalyEvent& ev) {
+  if (eventCount == ANOMALY_QUEUE_SIZE) {
+    eventsDropped++;
+    return;             // Keep the oldest - it started the excursion
+  }
+  events[(eventHead + eventCount) % ANOMALY_QUEUE_SIZE] = ev;
+  eventCount++;
+}
+
+/**
+ * Sampler listener - score the sample, then fold it into the baseline
+ */
+static void onSample(SensorChannel ch, float value, uint32_t t) {
+  if (ch >= CH_COUNT || isnan(value)) return;
+  ChannelState& s = state[ch];
+  const ChannelTuning& tu = tuning[ch];
+  chStats[ch].samples++;
+
+  if (s.seen == 0) {
+    s.mean = value;
+    s.var = 0.0f;
+    s.seen = 1;
+    return;
+  }
+
+  float diff = value - s.mean;
+  float sd = sqrtf(s.var);
+  if (sd < tu.minStd) sd = tu.minStd;
+  float z = diff / sd;
+  float absZ = fabsf(z);
+
+  if (s.seen >= ANOMALY_WARMUP) {
+    if (absZ > chStats[ch].maxAbsZ) chStats[ch].maxAbsZ = absZ;
+    if (!s.active && absZ >= ANOMALY_Z_ENTER) {
+      s.active = true;
+      chStats[ch].alerts++;
+      pushEvent({ch, value, s.mean, z, t});
+    } else if (s.active && absZ < ANOMALY_Z_EXIT) {
+      s.active = false;
+    }
+  } else {
+    s.seen++;
+  }
+
+  float alpha = 1.0f / (1UL << tu.alphaShift);
+  s.mean += alpha * diff;
+  s.var = (1.0f - alpha) * (s.var + alpha * diff * diff);
+}
+
+void anomalyBegin() {
+  for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+    state[ch] = {0.0f, 0.0f, 0, false};
+    chStats[ch] = {0, 0, 0.0f};
+  }
+  samplerAddListener(onSample);
+}
+
+bool anomalyTakeEvent(AnomalyEvent& out) {
+  if (eventCount == 0) return false;
+  out = events[eventHead];
+  eventHead = (eventHead + 1) % ANOMALY_QUEUE_SIZE;
+  eventCount--;
+  return true;
+}
+
+bool anomalyActive(SensorChannel ch) {
+  return ch < CH_COUNT && state[ch].active;
+}
+
+const AnomalyChannelStats& anomalyStats(SensorChannel ch) {
+  return chStats[ch < CH_COUNT ? ch : 0];
+}
+
+void anomalyPrintStats() {
+  CONSOLE("\n[ANOMALY] Detector statistics:\n");
+  CONSOLE("  Thresholds: enter |z| >= %.1f, exit < %.1f\n", ANOMALY_Z_ENTER, ANOMALY_Z_EXIT);
+  for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+    const ChannelInfo& ci = channelInfo((SensorChannel)ch);
+    const ChannelState& s = state[ch];
+    if (s.seen < ANOMALY_WARMUP) {
+      CONSOLE("  %s: warming up (%lu/%u)\n", ci.name, (unsigned long)s.seen, ANOMALY_WARMUP);
+      continue;
+    }
+    CONSOLE("  %s: %.1f +/- %.2f %s, %lu alerts, max |z| %.1f%s\n", ci.name, s.mean,
+            sqrtf(s.var), ci.unit, (unsigned long)chStats[ch].alerts, chStats[ch].maxAbsZ,
+            s.active ? " [ACTIVE]" : "");
+  }
+  if (eventsDropped) {
+    CONSOLE("  Dropped:    %lu\n", (unsigned long)eventsDropped);
+  }
+}
@@ -0,0 +1,60 @@
+// ============================================================================
+// anomaly.h - Streaming Anomaly Detector
+// ============================================================================
+// Purpose: Flag statistically significant sensor excursions as they happen
+// Method: Per-channel EWMA mean and variance, z-score of every new sample
+//         against the running baseline; an alert is raised when |z| crosses
+//         ANOMALY_Z_ENTER and re-armed only after it falls below
+//         ANOMALY_Z_EXIT (hysteresis, one alert per excursion)
+// Input: Sampler listener (every fresh channel value)
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include "sensors.h"
+
+/**
+ * One detected excursion
+ */
+struct AnomalyEvent {
+  SensorChannel channel;
+  float value;          // Sample that crossed the threshold
+  float mean;           // Baseline before the sample
+  float z;              // Signed z-score
+  uint32_t timestamp;   // millis() of the sample
+};
+
+/**
+ * Per-channel counters
+ */
+struct AnomalyChannelStats {
+  uint32_t samples;
+  uint32_t alerts;
+  float maxAbsZ;
+};
+
+/**
+ * Register with the sampler
+ */
+void anomalyBegin();
+
+/**
+ * Take the oldest pending event
+ * @return false if none is pending
+ */
+bool anomalyTakeEvent(AnomalyEvent& out);
+
+/**
+ * True while a channel is inside an excursion (between enter and exit)
+ */
+bool anomalyActive(SensorChannel ch);
+
+/**
+ * Get counters for one channel
+ */
+const AnomalyChannelStats& anomalyStats(SensorChannel ch);
+
+/**
+ * Print baselines and counters to Serial
+ */
+void anomalyPrintStats();
@@ -19,6 +19,7 @@
 
 // Sensor Input
 #define PIN_DHT        14    // GPIO14 (D5) - DHT11 temperature/humidity sensor
+#define PIN_LIGHT      A0    // A0          - HW-486 light sensor (inverted)
 
 // Digital LED Outputs (Part 2A)
 #define PIN_LED1       12    // GPIO12 (D6) - LED1 for visual feedback
@@ -32,9 +33,54 @@
 // ==== DHT Sensor ====
 #define DHTTYPE        11    // DHT11 sensor type
 
+// ==== Background Sampler ====
+#define SENSOR_MAX_DRIVERS      4    // Registry capacity (see sensors.cpp)
+#define SAMPLE_INTERVAL_MS   5000    // Scheduled DHT read period
+#define LIGHT_INTERVAL_MS      20    // Light sample ring drain period
+#define DHT_MIN_INTERVAL_MS  1000    // DHT11 limit: max 1 read per second
+#define SAMPLE_STALE_MS     10000    // Older samples trigger a background refresh
+#define SAMPLE_MAX_AGE_MS   60000    // Older samples are not logged
+#define SAMPLE_FAIL_WARN        5    // Warn after this many failures in a row
+#define SAMPLER_MAX_LISTENERS   4    // Sample consumers (aggregation, ...)
+
+// ==== ADC Acquisition (A0, timer0) ====
+#define ADC_SAMPLE_HZ         200    // Fixed sample rate (keep <= ~500 Hz for WiFi)
+#define ADC_RING_SIZE         128    // Ring slots (power of two, ~0.6 s at 200 Hz)
+#define ADC_TICK_HOOKS          2    // ISR jobs on the tick (inputs, LED effects)
+
+// ==== Lux Calibration (lux_calib.h) ====
+// The table is still a PLACEHOLDER - its points lie on the old Assn3 linear
+// fit (R² = 0.735), so lux is no more accurate than before until
+// LUX_CAL_POINTS holds meter readings. Set to 1 once it does; until then the
+// light driver warns at boot.
+#define LUX_CAL_MEASURED        0
+
+// ==== Windowed Aggregation ====
+#define AGG_WINDOW_MS       60000    // Tumbling window (KV_AGG_WINDOW_MS overrides)
+#define AGG_WINDOW_MIN_MS    1000    // Shortest window accepted by 'N<ms>'
+#define AGG_QUEUE_SIZE          4    // Closed windows waiting for upload
+
+// ==== Report-by-Exception ====
+#define DEADBAND_TEMP_C      0.5f    // Report if temperature moved > 0.5 C
+#define DEADBAND_HUMIDITY    2.0f    // Report if humidity moved > 2 %
+#define DEADBAND_LUX         5.0f    // Report if light moved > 5 lux ...
+#define DEADBAND_LUX_REL    0.10f    // ... or > 10% of the last reported value
+#define REPORT_HEARTBEAT_MS 900000   // Upload at least every 15 min regardless
+
+// ==== Anomaly Detection ====
+#define ANOMALY_Z_ENTER      4.0f    // Alert when |z| reaches this
+#define ANOMALY_Z_EXIT       2.0f    // Re-arm once |z| falls below this
+#define ANOMALY_WARMUP         16    // Samples before a channel can alert
+#define ANOMALY_QUEUE_SIZE      4    // Alerts waiting to be sent
+
 // ==== Time / EEPROM ====
-#define TZ_EEPROM_ADDR  0
-#define TZ_EEPROM_SIZE  64
+#define TZ_EEPROM_ADDR  0    // Legacy location, migrated into the KV store
+#define TZ_EEPROM_SIZE  64   // Also the maximum stored timezone length
+
+// ==== Persistent KV Store ====
+// Sectors are taken from the top of the (unused) filesystem region.
+// Reduce the FS size or disable the store before mounting LittleFS.
+#define KV_SECTOR_COUNT  4   // Sectors in rotation (wear leveling, 2..8)
 
 // ==== Backend URLs ====
 // Part 1: Sensor data logging
@@ -45,8 +91,81 @@
 #define RGB_CONTROL_URL "https://huynguyen.co/rgb_proxy.php"
 
 // ==== Timing Constants ====
+// Defaults - overridable at runtime through the KV store (serial 'B' / 'I')
 #define DEBOUNCE_DELAY_MS  50    // Switch debounce time
+#define DEBOUNCE_MIN_MS    20    // 4 timer ticks
+#define DEBOUNCE_MAX_MS  1000
+#define INPUT_LONG_PRESS_MS 1000  // Held this long -> long-press event
+#define INPUT_REPEAT_MS    250   // Then one repeat event per period
+#define INPUT_EVENT_RING    32   // Queued input events (power of two)
+#define EVENT_QUEUE_SIZE    16   // Application events waiting for a pipeline
+#define AUTO_POLL_INTERVAL_MS 10000  // Web command polling interval
+#define AUTO_POLL_MIN_MS    2000     // Each poll is two HTTPS requests
+#define PIPELINE_WIFI_WAIT_MS 15000  // Button pipelines wait this long for WiFi
+#define PIPELINE_SAMPLE_WAIT_MS 3000 // ... and this long for a fresh sample
 #define LED_BLINK_DURATION 2000  // Visual feedback duration (ms)
+#define LED_FX_MAX_CHANNELS   4  // Digital LEDs handled by the effect engine
+#define RGB_FADE_STEP_MS     10  // RGB fade update period (100 Hz)
+#define RGB_FADE_DEFAULT_MS 500  // Fade time when the server sends none
+
+// ==== Task Scheduler ====
+#define SCHED_MAX_TASKS     12   // Tasks listed in the 'T' profile
+#define SCHED_MAX_SLEEP_MS 1000  // Longest idle sleep (bounds wake latency)
+#define SCHED_INPUT_MS      20   // Button pipelines (also run on input wake)
+#define SCHED_SAMPLER_MS    50   // Sensor drivers, aggregation, anomalies
+#define SCHED_SERIAL_MS     50   // Serial command menu
+#define SCHED_HOUSEKEEP_MS 1000  // Window uploads, message batches
+#define SCHED_STRETCH_LOW_POWER 4 // Serial/input/sampler periods x4 outside active mode
+#define PROFILE_MAX_HISTOGRAMS 20 // Latency histograms in the 'P' dump (200 B each)
+
+// ==== Logging (logger.h) ====
+#ifndef LOG_LEVEL
+#define LOG_LEVEL           3    // 0 none, 1 error, 2 warn, 3 info, 4 debug (-D to override)
+#endif
+#define LOG_RING_SIZE    2048    // Bytes waiting for the UART (power of two, ~2 s at 9600)
+#define LOG_LINE_MAX      160    // Longest formatted line (box borders are 150 B of UTF-8)
+#define LOG_DRAIN_MS       10    // Drain period (the UART FIFO holds ~130 ms at 9600)
+
+// ==== Heap Tracer (heap_trace.h, needs -D HEAP_TRACE) ====
+#define HEAP_TRACE_SLOTS    256      // Live blocks tracked (power of two, 8 B each)
+#define HEAP_TREND_SAMPLES   16      // Free / largest-block history ...
+#define HEAP_TREND_MS    900000      // ... one sample per 15 min (4 h shown)
+
+// ==== Power Management ====
+// Currents are typical module figures for the charge model (power.h) -
+// replace them with values measured on your board
+#define POWER_DEFAULT_MODE      0    // 0 active, 1 light sleep, 2 deep-sleep duty cycle (see below)
+#define POWER_LISTEN_INTERVAL   3    // DTIM beacons between radio wakes (light sleep)
+#define POWER_ADC_SAMPLE_HZ    50    // timer0 tick (ADC + debounce) outside active mode
+// Deep-sleep timer wake needs GPIO16 (D0) wired to RST, and GPIO16 is
+// PIN_SWITCH_2: with the wire, every Switch 2 press resets the board; without
+// it, the board never wakes. Move Switch 2 to a free pin, add the wire, then
+// set POWER_DEEP_ENABLE - power.cpp refuses to build it while the pins clash.
+#define POWER_DEEP_ENABLE       0    // 1 = offer the deep-sleep duty cycle (mode 2)
+#define POWER_DEEP_SLEEP_MS 600000   // Sensor-only duty cycle period
+#define POWER_DEEP_GRACE_MS   5000   // Stay awake this long for a button press
+#define POWER_UA_BUSY        80000   // CPU running, radio active
+#define POWER_UA_IDLE_ACTIVE 70000   // Idle, radio always listening
+#define POWER_UA_IDLE_LIGHT   3000   // Idle in automatic light sleep (assumed reached)
+#define POWER_UA_DEEP           20   // Deep sleep (module; dev boards draw more)
+#define POWER_BATTERY_MAH     2000   // Capacity for the modelled battery life
+
+// ==== Memory Pools (mem_pool.h, static - taken from the heap at link time) ====
+#define POOL_64_BLOCKS      16   // JSON strings and small objects (1 KB)
+#define POOL_256_BLOCKS      8   // TLS client objects, replies, JSON pools (2 KB)
+#define POOL_1K_BLOCKS       4   // Upload payloads, response bodies, Slack posts (4 KB)
+#define POOL_4K_BLOCKS       0   // Spare class for larger documents (0 = none)
+
+// ==== String Buffers (static_string.h - longer text is cut off) ====
+#define URL_MAX            160   // Request URL with query string
+#define HTTP_BODY_MAX      512   // LED / RGB control response body
+#define HTTP_REPLY_MAX     256   // Server replies kept for the log
+#define TX_PAYLOAD_MAX     640   // Database JSON (summary: 5 fields per channel)
+#define MESSAGE_MAX_LEN    160   // One queued Slack message
+#define MESSAGE_POST_MAX  1024   // One batched Slack post (extra messages wait)
 
 // ==== Message Buffer Settings ====
 #define MAX_MESSAGE_QUEUE  10    // Maximum queued messages for transmission
+#define MESSAGE_BATCH_SIZE  4    // Send once this many routine messages wait ...
+#define MESSAGE_BATCH_MS 300000  // ... or the oldest has waited this long
+#define MESSAGE_RETRY_MS   5000  // Back-off after a failed send
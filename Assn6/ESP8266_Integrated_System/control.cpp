@@ -4,100 +4,104 @@
 
 #include "control.h"
 #include "config.h"
+#include "logger.h"
 #include "leds.h"
 #include "net.h"
+#include "heap_trace.h"
+#include "static_string.h"
+#include "mem_pool.h"
 #include <ESP8266HTTPClient.h>
 #include <WiFiClientSecure.h>
 
 // Last known timestamps to detect changes
-static String lastLedTimestamp = "";
-static String lastRgbData = "";
+static StaticString<40> lastLedTimestamp;
+static StaticString<50> lastRgbData;
 
 /**
- * Helper: Remove spaces/newlines and convert to uppercase
+ * Helper: Quoted value after "key": in a flat JSON object, or ok = false
  */
-static String upperNoSpace(String s) {
-  s.replace("\r", "");
-  s.replace("\n", "");
-  s.replace("\t", " ");
-  while (s.indexOf("  ") >= 0) s.replace("  ", " ");
-  s.replace(" ", "");
-  s.toUpperCase();
-  return s;
+static StringView jsonValue(StringView json, const char* key, bool caseless, bool& ok) {
+  ok = false;
+  StaticString<24> needle;
+  needle.append('"');
+  needle.append(key);
+  needle.append('"');
+
+  size_t pos = caseless ? json.indexOfIgnoreCase(needle) : json.indexOf(needle);
+  if (pos == StringView::npos) return StringView();
+
+  size_t colon = json.indexOf(':', pos + needle.length());
+  if (colon == StringView::npos) return StringView();
+
+  size_t i = colon + 1;
+  while (i < json.length() && isspace((unsigned char)json[i])) i++;
+
+  if (i >= json.length() || json[i] != '"') return StringView();
+  size_t q1 = i;
+  size_t q2 = json.indexOf('"', q1 + 1);
+  if (q2 == StringView::npos) return StringView();
+
+  ok = true;
+  return json.substr(q1 + 1, q2 - q1 - 1);
 }
 
 /**
- * Helper: Parse ON/OFF value from JSON
+ * Helper: Parse ON/OFF value from JSON (key and value in any case,
+ * whitespace around the value ignored)
  */
-static bool parseOnOff(const String& json, const char* key, bool& ok) {
-  ok = false;
-  String s = upperNoSpace(json);
-  String k = "\"";
-  k += key;
-  k += "\"";
-  k.toUpperCase();
-
-  int pos = s.indexOf(k);
-  if (pos < 0) return false;
-
-  pos = s.indexOf(":", pos);
-  if (pos < 0) return false;
-
-  int q1 = s.indexOf("\"", pos + 1);
-  if (q1 < 0) return false;
-  int q2 = s.indexOf("\"", q1 + 1);
-  if (q2 < 0) return false;
-
-  String val = s.substring(q1 + 1, q2);
-  ok = (val == "ON" || val == "OFF");
-  return (val == "ON");
+static bool parseOnOff(StringView json, const char* key, bool& ok) {
+  StringView val = jsonValue(json, key, true, ok).trim();
+  bool on = val.equalsIgnoreCase("ON");
+  ok = ok && (on || val.equalsIgnoreCase("OFF"));
+  return on;
 }
 
 /**
  * Helper: Get string value from JSON
  */
-static String getJsonString(const String& json, const char* key, bool& ok) {
-  ok = false;
-
-  String needle = String("\"") + key + String("\"");
-  int pos = json.indexOf(needle);
-  if (pos < 0) return "";
-
-  int colon = json.indexOf(':', pos + needle.length());
-  if (colon < 0) return "";
-
-  int i = colon + 1;
-  while (i < (int)json.length() && isspace(json[i])) i++;
-
-  if (i >= (int)json.length() || json[i] != '"') return "";
-  int q1 = i;
-  int q2 = json.indexOf('"', q1 + 1);
-  if (q2 < 0) return "";
+static StringView getJsonString(StringView json, const char* key, bool& ok) {
+  return jsonValue(json, key, false, ok);
+}
 
-  ok = true;
-  return json.substring(q1 + 1, q2);
+/**
+ * Helper: GET the response into body; false on HTTP error (code in code)
+ */
+static bool readBody(HTTPClient& http, StringBuffer& body, int& code) {
+  code = http.GET();
+  if (code != HTTP_CODE_OK) return false;
+  StringSink sink(body);
+  http.writeToStream(&sink);
+  if (body.truncated()) {
+    LOGW("CONTROL", "Response cut at HTTP_BODY_MAX");
+  }
+  return true;
 }
 
 /**
  * Initialize control module
  */
 void controlBegin() {
-  Serial.println("[CONTROL] Remote control module initialized");
+  LOGI("CONTROL", "Remote control module initialized");
 }
 
 /**
  * Poll LED control status from server - MEMORY LEAK FIXED
  */
 bool pollLEDControl() {
+  HEAP_SCOPE(HT_CONTROL);
   if (!ensureWiFi()) {
-    Serial.println("[CONTROL] No WiFi - skipping LED poll");
+    LOGW("CONTROL", "No WiFi - skipping LED poll");
     return false;
   }
 
-  Serial.println("[CONTROL] Polling LED status...");
+  LOGD("CONTROL", "Polling LED status...");
 
-  // FIX: Create new client each time (not static!)
-  WiFiClientSecure* client = new WiFiClientSecure();
+  // FIX: Create new client each time (not static!) - from the pools
+  std::unique_ptr<WiFiClientSecure, PoolDeleter> client(poolNew<WiFiClientSecure>());
+  if (!client) {
+    LOGE("CONTROL", "Out of memory for LED poll");
+    return false;
+  }
   client->setInsecure();
 
   HTTPClient http;
@@ -105,20 +109,19 @@ bool pollLEDControl() {
   http.setReuse(false);  // Don't reuse connections
 
   // Add cache-busting parameter
-  String url = String(LED_CONTROL_URL) + "?t=" + String(millis());
+  StaticString<URL_MAX> url = LED_CONTROL_URL;
+  url.appendf("?t=%lu", (unsigned long)millis());
 
-  if (!http.begin(*client, url)) {
-    Serial.println("[CONTROL] LED HTTP begin failed");
-    delete client;  // Clean up
+  if (!http.begin(*client, url.c_str())) {
+    LOGE("CONTROL", "LED HTTP begin failed");
     return false;
   }
 
-  int code = http.GET();
+  int code;
   bool changed = false;
+  PoolString body(HTTP_BODY_MAX);
 
-  if (code == HTTP_CODE_OK) {
-    String body = http.getString();
-
+  if (readBody(http, body, code)) {
     // Parse LED states
     bool ok1 = false, ok2 = false;
     bool newLed1 = parseOnOff(body, "led1", ok1);
@@ -128,8 +131,7 @@ bool pollLEDControl() {
       bool currentLed1 = getLED(PIN_LED1);
       if (newLed1 != currentLed1) {
         setLED(PIN_LED1, newLed1);
-        Serial.print("[CONTROL] LED1 -> ");
-        Serial.println(newLed1 ? "ON" : "OFF");
+        LOGI("CONTROL", "LED1 -> %s", newLed1 ? "ON" : "OFF");
         changed = true;
       }
     }
@@ -138,88 +140,96 @@ bool pollLEDControl() {
       bool currentLed2 = getLED(PIN_LED2);
       if (newLed2 != currentLed2) {
         setLED(PIN_LED2, newLed2);
-        Serial.print("[CONTROL] LED2 -> ");
-        Serial.println(newLed2 ? "ON" : "OFF");
+        LOGI("CONTROL", "LED2 -> %s", newLed2 ? "ON" : "OFF");
         changed = true;
       }
     }
 
     // Check timestamp for server-side updates
     bool tsOk = false;
-    String ts = getJsonString(body, "timestamp", tsOk);
+    StringView ts = getJsonString(body, "timestamp", tsOk);
     if (tsOk && ts.length() && ts != lastLedTimestamp) {
       lastLedTimestamp = ts;
       if (!changed) {
-        Serial.println("[CONTROL] LED timestamp updated (no state change)");
+        LOGD("CONTROL", "LED timestamp updated (no state change)");
       }
     }
 
   } else {
-    Serial.print("[CONTROL] LED HTTP error: ");
-    Serial.println(code);
+    LOGE("CONTROL", "LED HTTP error: %d", code);
   }
 
   http.end();
-  delete client;  // FIX: Clean up memory!
-  
   return changed;
 }
 
 /**
- * Poll RGB values from server - Already correct (creates new client)
+ * Poll RGB values from server - new pooled client each time, like the LED poll
  */
 bool pollRGBControl() {
+  HEAP_SCOPE(HT_CONTROL);
   if (!ensureWiFi()) {
-    Serial.println("[CONTROL] No WiFi - skipping RGB poll");
+    LOGW("CONTROL", "No WiFi - skipping RGB poll");
     return false;
   }
 
-  Serial.println("[CONTROL] Polling RGB values...");
+  LOGD("CONTROL", "Polling RGB values...");
 
-  WiFiClientSecure client;
-  client.setInsecure();
-  client.setBufferSizes(512, 512);
+  std::unique_ptr<WiFiClientSecure, PoolDeleter> client(poolNew<WiFiClientSecure>());
+  if (!client) {
+    LOGE("CONTROL", "Out of memory for RGB poll");
+    return false;
+  }
+  client->setInsecure();
+  client->setBufferSizes(512, 512);
 
   HTTPClient http;
   http.setTimeout(15000);
   http.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS);
   http.setReuse(false);
 
-  String url = String(RGB_CONTROL_URL) + "?t=" + String(millis());
+  StaticString<URL_MAX> url = RGB_CONTROL_URL;
+  url.appendf("?t=%lu", (unsigned long)millis());
 
-  if (!http.begin(client, url)) {
-    Serial.println("[CONTROL] RGB HTTP begin failed");
+  if (!http.begin(*client, url.c_str())) {
+    LOGE("CONTROL", "RGB HTTP begin failed");
     return false;
   }
 
   http.addHeader("Accept", "text/plain");
   http.addHeader("User-Agent", "ESP8266");
 
-  int code = http.GET();
+  int code;
   bool changed = false;
+  PoolString body(HTTP_BODY_MAX);
 
-  if (code == HTTP_CODE_OK || code == 200) {
-    String body = http.getString();
-    body.trim();
+  if (readBody(http, body, code)) {
+    StringView data = body.view().trim();
 
     // Check if response is HTML (error page)
-    if (body.indexOf("<html") >= 0 || body.indexOf("<!DOCTYPE") >= 0) {
-      Serial.println("[CONTROL] RGB got HTML redirect (server issue)");
+    if (data.indexOf("<html") != StringView::npos ||
+        data.indexOf("<!DOCTYPE") != StringView::npos) {
+      LOGW("CONTROL", "RGB got HTML redirect (server issue)");
       http.end();
       return false;
     }
 
-    // Parse RGB values (format: R,G,B)
-    if (body != lastRgbData && body.length() > 0 && body.length() < 50) {
-      lastRgbData = body;
-
-      int comma1 = body.indexOf(',');
-      int comma2 = body.indexOf(',', comma1 + 1);
-
-      if (comma1 > 0 && comma2 > comma1) {
-        int newR = body.substring(0, comma1).toInt();
-        int newG = body.substring(comma1 + 1, comma2).toInt();
-        int newB = body.substring(comma2 + 1).toInt();
+    // Parse RGB values (format: R,G,B or R,G,B,fade_ms)
+    if (data != lastRgbData && data.length() > 0 && data.length() < 50) {
+      lastRgbData = data;
+
+      size_t comma1 = data.indexOf(',');
+      size_t comma2 = data.indexOf(',', comma1 + 1);
+      size_t comma3 = data.indexOf(',', comma2 + 1);
+
+      if (comma1 != StringView::npos && comma1 > 0 && comma2 != StringView::npos) {
+        int newR = data.substr(0, comma1).toInt();
+        int newG = data.substr(comma1 + 1, comma2 - comma1 - 1).toInt();
+        int newB = data.substr(comma2 + 1, comma3 - comma2 - 1).toInt();
+        long fadeMs = RGB_FADE_DEFAULT_MS;
+        if (comma3 != StringView::npos) {
+          fadeMs = constrain(data.substr(comma3 + 1).toInt(), 0L, 60000L);
+        }
 
         // Constrain values
         newR = constrain(newR, 0, 255);
@@ -231,24 +241,18 @@ bool pollRGBControl() {
         getRGBColor(currR, currG, currB);
 
         if (newR != currR || newG != currG || newB != currB) {
-          setRGBColor(newR, newG, newB);
-          Serial.print("[CONTROL] RGB updated: R=");
-          Serial.print(newR);
-          Serial.print(", G=");
-          Serial.print(newG);
-          Serial.print(", B=");
-          Serial.println(newB);
+          fadeRGBColor(newR, newG, newB, fadeMs);
+          LOGI("CONTROL", "RGB updated: R=%d, G=%d, B=%d (fade %ld ms)",
+               newR, newG, newB, fadeMs);
           changed = true;
         }
       } else {
-        Serial.print("[CONTROL] Invalid RGB format: ");
-        Serial.println(body);
+        LOGW("CONTROL", "Invalid RGB format: %s", lastRgbData.c_str());
       }
     }
 
   } else {
-    Serial.print("[CONTROL] RGB HTTP error: ");
-    Serial.println(code);
+    LOGE("CONTROL", "RGB HTTP error: %d", code);
   }
 
   http.end();
@@ -268,26 +272,20 @@ bool pollAllControls() {
 /**
  * Get LED status as formatted string
  */
-String getLEDStatusString() {
-  String status = "LED1:";
-  status += getLED(PIN_LED1) ? "ON" : "OFF";
-  status += ", LED2:";
-  status += getLED(PIN_LED2) ? "ON" : "OFF";
+StatusString getLEDStatusString() {
+  StatusString status;
+  status.appendf("LED1:%s, LED2:%s",
+                 getLED(PIN_LED1) ? "ON" : "OFF", getLED(PIN_LED2) ? "ON" : "OFF");
   return status;
 }
 
 /**
  * Get RGB status as formatted string
  */
-String getRGBStatusString() {
+StatusString getRGBStatusString() {
   int r, g, b;
   getRGBColor(r, g, b);
-  String status = "RGB(";
-  status += String(r);
-  status += ",";
-  status += String(g);
-  status += ",";
-  status += String(b);
-  status += ")";
+  StatusString status;
+  status.appendf("RGB(%d,%d,%d)", r, g, b);
   return status;
 }
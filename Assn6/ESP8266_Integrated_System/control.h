@@ -7,6 +7,9 @@
 
 #pragma once
 #include <Arduino.h>
+#include "static_string.h"
+
+typedef StaticString<24> StatusString;
 
 /**
  * Initialize control module
@@ -35,10 +38,10 @@ bool pollAllControls();
  * Get current LED states as string for messaging
  * Returns formatted string like "LED1:ON, LED2:OFF"
  */
-String getLEDStatusString();
+StatusString getLEDStatusString();
 
 /**
  * Get current RGB values as string for messaging
  * Returns formatted string like "RGB(255,128,0)"
  */
-String getRGBStatusString();
+StatusString getRGBStatusString();
@@ -0,0 +1,163 @@
+// ============================================================================
+// dht_async.cpp - Interrupt-Driven DHT Driver Implementation
+// ============================================================================
+// Frame (after the host releases the line):
+//   F0: sensor pulls low (80us), high (80us)
+//   F1..F40: each bit = 50us low + 26-28us high ("0") or 70us high ("1")
+//   F41: sensor pulls low to end the frame
+// Only falling edges are captured, so bit i = period between F(i+1) and
+// F(i+2): ~78us for "0", ~120us for "1".
+// ============================================================================
+
+#include "dht_async.h"
+#include "gpio_hal.h"
+#include <Ticker.h>
+
+static const uint8_t  DHT_EDGES = 42;            // F0..F41
+static const uint16_t START_PULSE_DHT11_MS = 20; // Datasheet: >= 18ms
+static const uint16_t START_PULSE_DHT22_MS = 2;  // Datasheet: >= 1ms
+static const uint16_t FRAME_TIMEOUT_MS = 10;     // Frame takes ~4-5ms
+
+// Timing limits in microseconds
+static const uint16_t RESPONSE_MIN_US = 120;
+static const uint16_t RESPONSE_MAX_US = 220;
+static const uint16_t BIT_MIN_US = 60;
+static const uint16_t BIT_ONE_US = 100;          // Threshold "0" vs "1"
+static const uint16_t BIT_MAX_US = 160;
+
+static uint8_t dhtPin = 0;
+static uint8_t dhtType = 11;
+
+// Shared with the ISR
+static volatile uint32_t edges[DHT_EDGES];
+static volatile uint8_t edgeCount = 0;
+static volatile bool frameDone = false;
+
+static Ticker phaseTimer;
+static bool busy = false;
+static DhtCallback callback = nullptr;
+static DhtResult lastResult = {DHT_IDLE, NAN, NAN, 0};
+static DhtStats stats = {0, 0, 0, 0, 0, 0};
+
+/**
+ * Falling edge ISR - timestamp only
+ */
+static void IRAM_ATTR dhtEdgeISR() {
+  uint8_t n = edgeCount;
+  if (n < DHT_EDGES) {
+    edges[n] = ESP.getCycleCount();
+    edgeCount = n + 1;
+  }
+}
+
+/**
+ * Frame timeout - stop capturing, leave decoding to dhtPoll()
+ */
+static void onFrameTimeout() {
+  detachInterrupt(digitalPinToInterrupt(dhtPin));
+  frameDone = true;
+}
+
+/**
+ * End of host start pulse - release the line and listen
+ */
+static void onStartPulseDone() {
+  edgeCount = 0;
+  attachInterrupt(digitalPinToInterrupt(dhtPin), dhtEdgeISR, FALLING);
+  gpioDrive(dhtPin, false);   // Release - pull-up takes the line high
+  phaseTimer.once_ms(FRAME_TIMEOUT_MS, onFrameTimeout);
+}
+
+void dhtBegin(uint8_t pin, uint8_t type) {
+  dhtPin = pin;
+  dhtType = type;
+  pinMode(dhtPin, INPUT_PULLUP);
+  busy = false;
+}
+
+bool dhtStartRead(DhtCallback cb) {
+  if (busy) return false;
+
+  busy = true;
+  frameDone = false;
+  callback = cb;
+  stats.reads++;
+
+  // Host start pulse: drive low, the Ticker releases it
+  gpioWrite(dhtPin, false);
+  gpioDrive(dhtPin, true);
+  phaseTimer.once_ms(dhtType == 11 ? START_PULSE_DHT11_MS : START_PULSE_DHT22_MS,
+                     onStartPulseDone);
+  return true;
+}
+
+/**
+ * Convert captured edge timestamps into a result
+ */
+static DhtStatus decodeFrame(DhtResult& r) {
+  uint8_t n = edgeCount;
+  if (n < DHT_EDGES) return DHT_ERR_TIMEOUT;
+
+  uint32_t cyclesPerUs = ESP.getCpuFreqMHz();
+  uint32_t response = (edges[1] - edges[0]) / cyclesPerUs;
+  if (response < RESPONSE_MIN_US || response > RESPONSE_MAX_US) return DHT_ERR_TIMING;
+
+  uint8_t data[5] = {0, 0, 0, 0, 0};
+  for (uint8_t i = 0; i < 40; i++) {
+    uint32_t period = (edges[i + 2] - edges[i + 1]) / cyclesPerUs;
+    if (period < BIT_MIN_US || period > BIT_MAX_US) return DHT_ERR_TIMING;
+    data[i / 8] <<= 1;
+    if (period > BIT_ONE_US) data[i / 8] |= 1;
+  }
+  stats.lastFrameUs = (edges[DHT_EDGES - 1] - edges[0]) / cyclesPerUs;
+
+  if ((uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4]) {
+    return DHT_ERR_CHECKSUM;
+  }
+
+  if (dhtType == 11) {
+    r.humidity = data[0] + data[1] * 0.1f;
+    r.temperatureC = data[2] + (data[3] & 0x7F) * 0.1f;
+    if (data[3] & 0x80) r.temperatureC = -r.temperatureC;
+  } else {
+    r.humidity = ((data[0] << 8) | data[1]) * 0.1f;
+    r.temperatureC = (((data[2] & 0x7F) << 8) | data[3]) * 0.1f;
+    if (data[2] & 0x80) r.temperatureC = -r.temperatureC;
+  }
+  return DHT_OK;
+}
+
+DhtStatus dhtPoll(DhtResult* out) {
+  if (busy && frameDone) {
+    DhtResult r = {DHT_BUSY, NAN, NAN, (uint32_t)millis()};
+    r.status = decodeFrame(r);
+
+    switch (r.status) {
+      case DHT_OK:           stats.ok++; break;
+      case DHT_ERR_TIMEOUT:  stats.timeouts++; break;
+      case DHT_ERR_TIMING:   stats.timingErrors++; break;
+      case DHT_ERR_CHECKSUM: stats.checksumErrors++; break;
+      default: break;
+    }
+
+    lastResult = r;
+    busy = false;
+
+    if (callback) {
+      DhtCallback cb = callback;
+      callback = nullptr;
+      cb(lastResult);
+    }
+  }
+
+  if (out) *out = lastResult;
+  return busy ? DHT_BUSY : lastResult.status;
+}
+
+bool dhtBusy() {
+  return busy;
+}
+
+const DhtStats& dhtStats() {
+  return stats;
+}
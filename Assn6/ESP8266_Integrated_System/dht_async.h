@@ -0,0 +1,78 @@
+// ============================================================================
+// dht_async.h - Interrupt-Driven DHT11/DHT22 Driver
+// ============================================================================
+// Purpose: Read DHT sensors without bit-banging with interrupts disabled
+// Method: Host start pulse is timed by a Ticker, the sensor's falling edges
+//         are timestamped by a GPIO interrupt, and the 40-bit frame is
+//         decoded later in loop context (dhtPoll)
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+/**
+ * Read status
+ */
+enum DhtStatus : uint8_t {
+  DHT_IDLE = 0,         // No read started
+  DHT_BUSY,             // Start pulse or frame transfer in progress
+  DHT_OK,               // Valid result
+  DHT_ERR_TIMEOUT,      // Sensor did not answer / frame incomplete
+  DHT_ERR_TIMING,       // Edge timings out of specification
+  DHT_ERR_CHECKSUM      // Frame received but checksum mismatch
+};
+
+/**
+ * Decoded reading
+ */
+struct DhtResult {
+  DhtStatus status;
+  float temperatureC;
+  float humidity;
+  uint32_t timestamp;   // millis() when the frame was decoded
+};
+
+/**
+ * Error and timing counters
+ */
+struct DhtStats {
+  uint32_t reads;
+  uint32_t ok;
+  uint32_t timeouts;
+  uint32_t timingErrors;
+  uint32_t checksumErrors;
+  uint32_t lastFrameUs;   // Duration of the last frame transfer
+};
+
+typedef void (*DhtCallback)(const DhtResult& result);
+
+/**
+ * Initialize the driver
+ * @param pin GPIO connected to the DHT data line (must support interrupts)
+ * @param type 11 for DHT11, 22 for DHT22
+ */
+void dhtBegin(uint8_t pin, uint8_t type);
+
+/**
+ * Start an asynchronous read. Returns immediately.
+ * @param cb Optional callback, invoked from dhtPoll() when the read finishes
+ * @return false if a read is already in progress
+ */
+bool dhtStartRead(DhtCallback cb = nullptr);
+
+/**
+ * Decode a completed frame and deliver the result (call from loop)
+ * @param out Optional, receives the latest result
+ * @return DHT_BUSY while in progress, otherwise the status of the last read
+ */
+DhtStatus dhtPoll(DhtResult* out = nullptr);
+
+/**
+ * True while a read is in progress
+ */
+bool dhtBusy();
+
+/**
+ * Get driver statistics
+ */
+const DhtStats& dhtStats();
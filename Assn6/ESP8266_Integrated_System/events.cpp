@@ -0,0 +1,93 @@
+// ============================================================================
+// events.cpp - Typed Application Event Queue Implementation
+// ============================================================================
+
+#include "events.h"
+#include "config.h"
+#include "logger.h"
+
+// Indexed by EventSource
+static const CoalescePolicy policy[EVT_SRC_COUNT] = {
+  COALESCE_BATCH,         // Button 1: all pending presses -> one upload
+  COALESCE_BATCH          // Button 2: one status check covers every press
+};
+static const char* const sourceNames[EVT_SRC_COUNT] = {"Button 1", "Button 2"};
+static_assert(sizeof(policy) / sizeof(policy[0]) == EVT_SRC_COUNT,
+              "One coalescing policy per event source");
+
+static AppEvent queue[EVENT_QUEUE_SIZE];
+static uint8_t queueCount = 0;          // Events in queue[0..count), oldest first
+static uint32_t nextSeq = 1;
+static EventSourceStats stats[EVT_SRC_COUNT];
+
+bool eventPost(EventSource source, EventType type, uint32_t timestamp) {
+  if (source >= EVT_SRC_COUNT) return false;
+  stats[source].posted++;
+  uint32_t seq = nextSeq++;
+
+  if (queueCount >= EVENT_QUEUE_SIZE) {
+    stats[source].overflows++;
+    LOGW("EVENTS", "Queue full - %s event #%lu dropped", sourceNames[source],
+         (unsigned long)seq);
+    return false;
+  }
+
+  queue[queueCount++] = {seq, timestamp, source, type};
+  return true;
+}
+
+/**
+ * Remove entry i, keeping FIFO order
+ */
+static void removeAt(uint8_t i) {
+  for (; i + 1 < queueCount; i++) queue[i] = queue[i + 1];
+  queueCount--;
+}
+
+bool eventTake(EventSource source, EventType type, EventBatch& out) {
+  if (source >= EVT_SRC_COUNT) return false;
+  out.count = 0;
+
+  uint8_t i = 0;
+  while (i < queueCount) {
+    const AppEvent& e = queue[i];
+    if (e.source != source || e.type != type) {
+      i++;
+      continue;
+    }
+    if (out.count == 0) out.first = e;
+    out.lastSeq = e.seq;
+    out.lastTimestamp = e.timestamp;
+    out.count++;
+    removeAt(i);
+    if (policy[source] == COALESCE_NONE) break;
+  }
+
+  if (out.count == 0) return false;
+  stats[source].taken += out.count;
+  stats[source].batches++;
+  return true;
+}
+
+uint32_t eventNextSeq() {
+  return nextSeq;
+}
+
+void eventRestoreSeq(uint32_t next) {
+  if (next > nextSeq) nextSeq = next;
+}
+
+const EventSourceStats& eventStats(EventSource source) {
+  return stats[source < EVT_SRC_COUNT ? source : 0];
+}
+
+void eventsPrintStats() {
+  CONSOLE("\n[EVENTS] Event queue statistics:\n");
+  CONSOLE("  Queued:    %u/%u\n", queueCount, EVENT_QUEUE_SIZE);
+  for (uint8_t s = 0; s < EVT_SRC_COUNT; s++) {
+    CONSOLE("  %s: %lu posted, %lu handled in %lu %s, %lu overflowed\n", sourceNames[s],
+            (unsigned long)stats[s].posted, (unsigned long)stats[s].taken,
+            (unsigned long)stats[s].batches, policy[s] == COALESCE_BATCH ? "batches" : "takes",
+            (unsigned long)stats[s].overflows);
+  }
+}
@@ -0,0 +1,81 @@
+// ============================================================================
+// events.h - Typed Application Event Queue
+// ============================================================================
+// Purpose: Carry input events from the input layer to the application
+//          without merging or losing them
+// Features: Bounded FIFO of typed events (source, type, timestamp, sequence
+//           number), per-source coalescing policy, overflow counters
+// Producers: pollSwitches() (loop context)
+// Consumers: Button pipelines in main.cpp
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+enum EventSource : uint8_t {
+  EVT_SRC_SWITCH1 = 0,    // Button 1 - sensor logging
+  EVT_SRC_SWITCH2,        // Button 2 - LED/RGB status
+  EVT_SRC_COUNT
+};
+
+enum EventType : uint8_t {
+  EVT_PRESS = 0           // Long press / repeat have no action (pollSwitches)
+};
+
+/**
+ * How pending events of one source are handed to the application
+ */
+enum CoalescePolicy : uint8_t {
+  COALESCE_NONE = 0,      // One event per take
+  COALESCE_BATCH          // All pending events of the source in one take
+};
+
+struct AppEvent {
+  uint32_t seq;           // Global sequence number (gaps = overflow)
+  uint32_t timestamp;     // millis() at the input transition
+  EventSource source;
+  EventType type;
+};
+
+/**
+ * Result of one take: the first event plus how many were coalesced into it
+ */
+struct EventBatch {
+  AppEvent first;
+  uint32_t lastSeq;
+  uint32_t lastTimestamp;
+  uint8_t count;
+};
+
+struct EventSourceStats {
+  uint32_t posted;
+  uint32_t taken;         // Events handed out (coalesced ones included)
+  uint32_t batches;       // Takes
+  uint32_t overflows;     // Events dropped because the queue was full
+};
+
+/**
+ * Queue an event
+ * @return false (and counted) if the queue is full
+ */
+bool eventPost(EventSource source, EventType type, uint32_t timestamp);
+
+/**
+ * Take pending events of one source and type, according to its policy
+ * @return false if none is pending
+ */
+bool eventTake(EventSource source, EventType type, EventBatch& out);
+
+const EventSourceStats& eventStats(EventSource source);
+
+/**
+ * Sequence number of the next event, and restoring it after a deep sleep
+ * so numbering continues instead of restarting at 1
+ */
+uint32_t eventNextSeq();
+void eventRestoreSeq(uint32_t next);
+
+/**
+ * Print queue counters to Serial
+ */
+void eventsPrintStats();
@@ -0,0 +1,214 @@
+// ============================================================================
+// filters.h - Integer / Fixed-Point Signal Filters
+// ============================================================================
+// Purpose: Reusable O(1) filters for ADC and sensor streams
+// Features: All buffers sized at compile time (template window sizes),
+//           integer math only - no floats, no heap
+// Filters:
+//   MovingAverage<N>   running-sum moving average
+//   MedianFilter<N>    median-of-N spike rejector
+//   Ewma<SHIFT, FRAC>  exponentially weighted moving average (alpha = 2^-SHIFT)
+//   Oversampler<N>     decimating accumulator (N samples -> 1 output)
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+/**
+ * Compile-time log2 for power-of-two sizes
+ */
+constexpr uint8_t filterLog2(uint32_t n) {
+  return (n <= 1) ? 0 : 1 + filterLog2(n >> 1);
+}
+
+constexpr bool filterIsPow2(uint32_t n) {
+  return n && !(n & (n - 1));
+}
+
+/**
+ * Moving average over the last N samples.
+ * Keeps a running sum: each push is one add, one subtract, one store.
+ * For power-of-two N the division compiles to a shift.
+ */
+template <uint16_t N, typename T = int32_t>
+class MovingAverage {
+  static_assert(N > 0, "Window must not be empty");
+
+ public:
+  /**
+   * Add a sample and return the current average
+   */
+  T push(T x) {
+    sum_ += (int32_t)x - (int32_t)buf_[idx_];
+    buf_[idx_] = x;
+    idx_ = (idx_ + 1 == N) ? 0 : idx_ + 1;
+    if (count_ < N) count_++;
+    return value();
+  }
+
+  /**
+   * Current average (of the samples seen so far until the window fills)
+   */
+  T value() const {
+    if (count_ == 0) return 0;
+    return (T)((count_ == N) ? divide(sum_) : sum_ / (int32_t)count_);
+  }
+
+  /**
+   * Raw window sum - average with log2(N) extra fraction bits for pow2 N
+   */
+  int32_t sum() const { return sum_; }
+
+  bool full() const { return count_ == N; }
+
+  void reset() {
+    memset(buf_, 0, sizeof(buf_));
+    sum_ = 0;
+    idx_ = 0;
+    count_ = 0;
+  }
+
+ private:
+  static int32_t divide(int32_t s) {
+    return filterIsPow2(N) ? (s >> filterLog2(N)) : s / (int32_t)N;
+  }
+
+  T buf_[N] = {};
+  int32_t sum_ = 0;
+  uint16_t idx_ = 0;
+  uint16_t count_ = 0;
+};
+
+/**
+ * Median of the last N samples (N odd). Rejects single-sample spikes
+ * for N=3, up to (N-1)/2 consecutive outliers in general.
+ * Keeps the window sorted: one O(N) remove + insert per push.
+ */
+template <uint8_t N, typename T = int32_t>
+class MedianFilter {
+  static_assert(N % 2 == 1, "Median window must be odd");
+  static_assert(N <= 31, "Median window too large for an O(N) filter");
+
+ public:
+  T push(T x) {
+    if (count_ == N) {
+      removeSorted(ring_[idx_]);
+    } else {
+      count_++;
+    }
+    ring_[idx_] = x;
+    idx_ = (idx_ + 1 == N) ? 0 : idx_ + 1;
+    insertSorted(x, count_ - 1);
+    return value();
+  }
+
+  T value() const {
+    return count_ ? sorted_[(count_ - 1) / 2] : 0;
+  }
+
+  bool full() const { return count_ == N; }
+
+  void reset() {
+    count_ = 0;
+    idx_ = 0;
+  }
+
+ private:
+  void removeSorted(T x) {
+    uint8_t i = 0;
+    while (i < N - 1 && sorted_[i] != x) i++;
+    for (; i < N - 1; i++) sorted_[i] = sorted_[i + 1];
+  }
+
+  void insertSorted(T x, uint8_t used) {
+    uint8_t i = used;
+    while (i > 0 && sorted_[i - 1] > x) {
+      sorted_[i] = sorted_[i - 1];
+      i--;
+    }
+    sorted_[i] = x;
+  }
+
+  T ring_[N] = {};
+  T sorted_[N] = {};
+  uint8_t idx_ = 0;
+  uint8_t count_ = 0;
+};
+
+/**
+ * Exponentially weighted moving average, alpha = 1 / 2^SHIFT.
+ * State is kept with FRAC extra fraction bits so small steps are not lost.
+ * The first sample initializes the state (no slow start from zero).
+ */
+template <uint8_t SHIFT, uint8_t FRAC = 8>
+class Ewma {
+  static_assert(SHIFT > 0 && SHIFT < 16, "SHIFT must be 1..15");
+  static_assert(FRAC <= 16, "FRAC must be 0..16");
+
+ public:
+  static constexpr uint8_t FRACTION_BITS = FRAC;
+
+  int32_t push(int32_t x) {
+    int32_t xq = x * (1L << FRAC);
+    if (!init_) {
+      state_ = xq;
+      init_ = true;
+    } else {
+      state_ += (xq - state_) / (1L << SHIFT);
+    }
+    return value();
+  }
+
+  /**
+   * Rounded integer output
+   */
+  int32_t value() const {
+    return (state_ + (FRAC ? (1L << (FRAC - 1)) : 0)) >> FRAC;
+  }
+
+  /**
+   * Fixed-point output with FRAC fraction bits
+   */
+  int32_t raw() const { return state_; }
+
+  void reset() { init_ = false; state_ = 0; }
+
+ private:
+  int32_t state_ = 0;
+  bool init_ = false;
+};
+
+/**
+ * Decimating oversampler: accumulates N samples and emits one output.
+ * N must be a power of two; value() is the average with log2(N) extra
+ * fraction bits (Q.log2N), average() is the plain integer average.
+ */
+template <uint16_t N>
+class Oversampler {
+  static_assert(filterIsPow2(N), "Oversample count must be a power of two");
+
+ public:
+  static constexpr uint8_t FRACTION_BITS = filterLog2(N);
+
+  /**
+   * Add a sample. Returns true when a new output is ready.
+   */
+  bool push(int32_t x) {
+    acc_ += x;
+    if (++count_ < N) return false;
+    out_ = acc_;
+    acc_ = 0;
+    count_ = 0;
+    return true;
+  }
+
+  int32_t value() const { return out_; }
+  int32_t average() const { return out_ >> FRACTION_BITS; }
+
+  void reset() { acc_ = 0; count_ = 0; out_ = 0; }
+
+ private:
+  int32_t acc_ = 0;
+  int32_t out_ = 0;
+  uint16_t count_ = 0;
+};
@@ -0,0 +1,51 @@
+// ============================================================================
+// gamma.h - Compile-Time Gamma Correction Table
+// ============================================================================
+// Purpose: Map perceived brightness to PWM duty so equal steps in colour
+//          value look like equal steps in brightness
+// Method: duty = round(1023 * (level / 1023) ^ 2.2), generated constexpr
+//         for every 10-bit level; the table lives in flash (leds.cpp)
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+static constexpr uint16_t GAMMA_LEVELS = 1024;   // 10-bit in, 10-bit out
+static constexpr uint16_t GAMMA_MAX = GAMMA_LEVELS - 1;
+
+struct GammaLut {
+  uint16_t duty[GAMMA_LEVELS];
+};
+
+/**
+ * Fifth root by Newton iteration (std::pow is not constexpr)
+ */
+constexpr double gammaRoot5(double x) {
+  double y = 1.0;
+  for (uint8_t i = 0; i < 40; i++) {
+    y = (4.0 * y + x / (y * y * y * y)) / 5.0;
+  }
+  return y;
+}
+
+/**
+ * x ^ 2.2 = x^2 * x^(1/5)
+ */
+constexpr double gammaCurve(double x) {
+  return x <= 0.0 ? 0.0 : x * x * gammaRoot5(x);
+}
+
+constexpr GammaLut gammaMakeTable() {
+  GammaLut t = {};
+  for (uint16_t i = 0; i < GAMMA_LEVELS; i++) {
+    t.duty[i] = (uint16_t)(gammaCurve((double)i / GAMMA_MAX) * GAMMA_MAX + 0.5);
+  }
+  return t;
+}
+
+/**
+ * Expand an 8-bit colour value to a 10-bit level (255 -> 1023)
+ */
+constexpr uint16_t gammaLevel8(uint8_t v) {
+  return ((uint16_t)v << 2) | (v >> 6);
+}
@@ -0,0 +1,54 @@
+// ============================================================================
+// gpio_bench.cpp - GPIO HAL Cycle-Count Benchmark
+// ============================================================================
+// Runs on LED1 (write) and Switch 1 (read). LED1 flickers for a few
+// microseconds and is restored to its previous level.
+// ============================================================================
+
+#include <Arduino.h>
+#include "gpio_hal.h"
+#include "config.h"
+#include "logger.h"
+
+static const uint16_t BENCH_OPS = 1000;
+
+typedef GpioPin<PIN_LED1> BenchOut;
+typedef GpioPin<PIN_SWITCH_1> BenchIn;
+
+static void printResult(const char* name, uint32_t arduino, uint32_t hal) {
+  CONSOLE("  %s: Arduino %.1f cycles, HAL %.1f cycles (%.1fx)\n", name,
+          (float)arduino / BENCH_OPS, (float)hal / BENCH_OPS,
+          hal ? (float)arduino / hal : 0.0f);
+}
+
+void gpioBenchmark() {
+  bool level = BenchOut::state();
+  volatile uint32_t sink = 0;
+  uint32_t t0, arduinoWrite, halWrite, arduinoRead, halRead;
+
+  noInterrupts();
+
+  t0 = ESP.getCycleCount();
+  for (uint16_t i = 0; i < BENCH_OPS; i++) digitalWrite(PIN_LED1, i & 1);
+  arduinoWrite = ESP.getCycleCount() - t0;
+
+  t0 = ESP.getCycleCount();
+  for (uint16_t i = 0; i < BENCH_OPS; i++) BenchOut::write(i & 1);
+  halWrite = ESP.getCycleCount() - t0;
+
+  t0 = ESP.getCycleCount();
+  for (uint16_t i = 0; i < BENCH_OPS; i++) sink += digitalRead(PIN_SWITCH_1);
+  arduinoRead = ESP.getCycleCount() - t0;
+
+  t0 = ESP.getCycleCount();
+  for (uint16_t i = 0; i < BENCH_OPS; i++) sink += BenchIn::read();
+  halRead = ESP.getCycleCount() - t0;
+
+  BenchOut::write(level);
+  interrupts();
+
+  CONSOLE("\n[GPIO] Benchmark, %u ops @ %u MHz (incl. loop overhead):\n",
+          BENCH_OPS, ESP.getCpuFreqMHz());
+  printResult("write", arduinoWrite, halWrite);
+  printResult("read ", arduinoRead, halRead);
+}
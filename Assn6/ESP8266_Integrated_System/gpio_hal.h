@@ -0,0 +1,187 @@
+// ============================================================================
+// gpio_hal.h - Compile-Time GPIO Hardware Abstraction
+// ============================================================================
+// Purpose: Replace digitalWrite()/digitalRead() in the hot paths with
+//          single register accesses
+// Method: GpioPin<N> is templated on the pin number, so every mask is a
+//         constant: write = one store to GPOS/GPOC, read = one load of GPI.
+//         GPIO16 lives in the RTC block (GP16O/GP16I) and has its own
+//         specialization.
+// Checks: static_asserts reject the SPI flash pins (GPIO6-11), pull-ups on
+//         GPIO15 (boot strap, must stay low) and GPIO16 (no pull-up in
+//         hardware), and pin sharing (gpioPinsDistinct)
+// Host: Without ARDUINO the registers are a plain struct (gpioHost), so
+//       drivers can be compiled and exercised on a PC
+// Pin modes are configured once with pinMode(); only I/O and output-enable
+// switching go through the registers directly.
+// ============================================================================
+
+#pragma once
+#include <stdint.h>
+
+// Register helpers must inline even at -Os: the hot paths, and the input
+// tick running in ISR context, must not call into flash
+#define GPIO_HAL_INLINE inline __attribute__((always_inline))
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+namespace gpio_regs {
+  GPIO_HAL_INLINE void set(uint32_t m)        { GPOS = m; }
+  GPIO_HAL_INLINE void clear(uint32_t m)      { GPOC = m; }
+  GPIO_HAL_INLINE uint32_t in()               { return GPI; }
+  GPIO_HAL_INLINE uint32_t out()              { return GPO; }
+  GPIO_HAL_INLINE void enable(uint32_t m)     { GPES = m; }
+  GPIO_HAL_INLINE void disable(uint32_t m)    { GPEC = m; }
+  GPIO_HAL_INLINE void set16(bool v)          { if (v) GP16O |= 1; else GP16O &= ~1; }
+  GPIO_HAL_INLINE bool in16()                 { return GP16I & 1; }
+  GPIO_HAL_INLINE bool out16()                { return GP16O & 1; }
+  GPIO_HAL_INLINE void enable16(bool v)       { if (v) GP16E |= 1; else GP16E &= ~1; }
+  inline void mode(uint8_t pin, uint8_t m) { pinMode(pin, m); }
+}
+
+#else  // Host mock
+
+#ifndef INPUT
+#define INPUT         0x00
+#define OUTPUT        0x01
+#define INPUT_PULLUP  0x02
+#endif
+
+/**
+ * Simulated GPIO block. Tests drive `in`/`in16` and inspect the rest.
+ */
+struct GpioHostRegs {
+  uint32_t out;
+  uint32_t enable;
+  uint32_t in;
+  uint32_t pullup;
+  bool out16;
+  bool enable16;
+  bool in16;
+  uint32_t accesses;    // Register accesses (for cost comparisons)
+};
+inline GpioHostRegs gpioHost = {};
+
+namespace gpio_regs {
+  inline void set(uint32_t m)        { gpioHost.out |= m; gpioHost.accesses++; }
+  inline void clear(uint32_t m)      { gpioHost.out &= ~m; gpioHost.accesses++; }
+  inline uint32_t in()               { gpioHost.accesses++; return gpioHost.in; }
+  inline uint32_t out()              { gpioHost.accesses++; return gpioHost.out; }
+  inline void enable(uint32_t m)     { gpioHost.enable |= m; gpioHost.accesses++; }
+  inline void disable(uint32_t m)    { gpioHost.enable &= ~m; gpioHost.accesses++; }
+  inline void set16(bool v)          { gpioHost.out16 = v; gpioHost.accesses++; }
+  inline bool in16()                 { gpioHost.accesses++; return gpioHost.in16; }
+  inline bool out16()                { gpioHost.accesses++; return gpioHost.out16; }
+  inline void enable16(bool v)       { gpioHost.enable16 = v; gpioHost.accesses++; }
+  inline void mode(uint8_t pin, uint8_t m) {
+    uint32_t bit = 1UL << pin;
+    if (pin == 16) { gpioHost.enable16 = (m == OUTPUT); return; }
+    gpioHost.enable = (m == OUTPUT) ? (gpioHost.enable | bit) : (gpioHost.enable & ~bit);
+    gpioHost.pullup = (m == INPUT_PULLUP) ? (gpioHost.pullup | bit) : (gpioHost.pullup & ~bit);
+  }
+}
+
+#endif
+
+/**
+ * True for pins that can be used as GPIO on the ESP8266
+ */
+constexpr bool gpioPinUsable(uint8_t pin) {
+  return pin <= 16 && !(pin >= 6 && pin <= 11);
+}
+
+/**
+ * True if no pin appears twice and all pins are usable
+ */
+template <uint8_t... PINS>
+constexpr bool gpioPinsDistinct() {
+  const uint8_t pins[] = {PINS...};
+  uint32_t seen = 0;
+  for (uint8_t p : pins) {
+    if (!gpioPinUsable(p) || (seen & (1UL << p))) return false;
+    seen |= 1UL << p;
+  }
+  return true;
+}
+
+/**
+ * GPIO0..15 (except the flash pins)
+ */
+template <uint8_t PIN>
+struct GpioPin {
+  static_assert(gpioPinUsable(PIN), "GPIO6-11 are wired to the SPI flash");
+  static constexpr uint32_t MASK = 1UL << PIN;
+
+  static void output()      { gpio_regs::mode(PIN, OUTPUT); }
+  static void input()       { gpio_regs::mode(PIN, INPUT); }
+  static void inputPullup() {
+    static_assert(PIN != 15, "GPIO15 must stay low at boot - no pull-up");
+    gpio_regs::mode(PIN, INPUT_PULLUP);
+  }
+
+  static inline void high()          { gpio_regs::set(MASK); }
+  static inline void low()           { gpio_regs::clear(MASK); }
+  static inline void write(bool v)   { if (v) high(); else low(); }
+  static inline bool read()          { return gpio_regs::in() & MASK; }
+  static inline bool state()         { return gpio_regs::out() & MASK; }
+
+  // Direction switch without touching the pin function (open-drain style)
+  static inline void driveEnable()   { gpio_regs::enable(MASK); }
+  static inline void driveDisable()  { gpio_regs::disable(MASK); }
+};
+
+/**
+ * GPIO16 (RTC block, no interrupts, no pull-up)
+ */
+template <>
+struct GpioPin<16> {
+  static void output()      { gpio_regs::mode(16, OUTPUT); }
+  static void input()       { gpio_regs::mode(16, INPUT); }
+  template <bool ALLOWED = false>
+  static void inputPullup() {
+    static_assert(ALLOWED, "GPIO16 has no internal pull-up - use an external resistor");
+  }
+
+  static inline void high()          { gpio_regs::set16(true); }
+  static inline void low()           { gpio_regs::set16(false); }
+  static inline void write(bool v)   { gpio_regs::set16(v); }
+  static inline bool read()          { return gpio_regs::in16(); }
+  static inline bool state()         { return gpio_regs::out16(); }
+
+  static inline void driveEnable()   { gpio_regs::enable16(true); }
+  static inline void driveDisable()  { gpio_regs::enable16(false); }
+};
+
+/**
+ * Runtime-pin variants for pin tables (LED effect engine, DHT driver).
+ * One compare for GPIO16, then the same single register access.
+ */
+GPIO_HAL_INLINE void gpioWrite(uint8_t pin, bool v) {
+  if (pin == 16) gpio_regs::set16(v);
+  else if (v) gpio_regs::set(1UL << pin);
+  else gpio_regs::clear(1UL << pin);
+}
+
+GPIO_HAL_INLINE bool gpioRead(uint8_t pin) {
+  return (pin == 16) ? gpio_regs::in16() : (gpio_regs::in() >> pin) & 1;
+}
+
+/**
+ * All inputs in one word, bit n = GPIO n (GPI + GP16I)
+ */
+GPIO_HAL_INLINE uint32_t gpioReadAll() {
+  return (gpio_regs::in() & 0xFFFF) | ((uint32_t)gpio_regs::in16() << 16);
+}
+
+GPIO_HAL_INLINE void gpioDrive(uint8_t pin, bool enable) {
+  if (pin == 16) gpio_regs::enable16(enable);
+  else if (enable) gpio_regs::enable(1UL << pin);
+  else gpio_regs::disable(1UL << pin);
+}
+
+/**
+ * Compare digitalWrite()/digitalRead() against the HAL (gpio_bench.cpp)
+ * and print cycles per operation
+ */
+void gpioBenchmark();
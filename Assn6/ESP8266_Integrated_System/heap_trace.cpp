@@ -0,0 +1,216 @@
+// ============================================================================
+// heap_trace.cpp - Heap Allocation Tracer Implementation
+// ============================================================================
+// The wrappers run for every allocation in the firmware, so they must not
+// allocate themselves: all storage is static. The table is updated with
+// interrupts masked - allocations happen in CONT and SYS context, which do
+// not preempt each other, but an ISR may still free a block.
+// ============================================================================
+
+#include "heap_trace.h"
+#include "config.h"
+#include "logger.h"
+
+static const char* const heapTagNames[HT_COUNT] = {
+  "other", "app", "net", "time", "tx", "control", "messaging", "ifttt"
+};
+static_assert(sizeof(heapTagNames) / sizeof(heapTagNames[0]) == HT_COUNT,
+              "One name per heap tag");
+
+static HeapTagStats tagStats[HT_COUNT];
+
+struct HeapSample {
+  uint32_t at;             // millis() / 1000
+  uint16_t freeBytes;
+  uint16_t maxBlock;
+};
+static HeapSample trend[HEAP_TREND_SAMPLES];
+static uint8_t trendCount = 0;
+static uint8_t trendNext = 0;
+static uint32_t lastSample = 0;
+
+#ifdef HEAP_TRACE
+
+struct TraceSlot {
+  uint32_t ptr;            // 0 = empty
+  uint16_t size;
+  uint8_t tag;
+};
+
+static TraceSlot slots[HEAP_TRACE_SLOTS];
+static_assert((HEAP_TRACE_SLOTS & (HEAP_TRACE_SLOTS - 1)) == 0,
+              "HEAP_TRACE_SLOTS must be a power of two");
+
+static volatile uint8_t currentTag = HT_OTHER;
+static uint16_t tracked = 0;
+static uint16_t trackedPeak = 0;
+static uint32_t untracked = 0;     // Table full - block not attributed
+
+extern "C" {
+void* __real_malloc(size_t size);
+void __real_free(void* ptr);
+void* __real_realloc(void* ptr, size_t size);
+void* __real_calloc(size_t n, size_t size);
+}
+
+static inline uint32_t addrOf(const void* p) {
+  return (uint32_t)(uintptr_t)p;
+}
+
+static inline uint16_t slotOf(uint32_t p) {
+  // umm blocks are 8-byte aligned; Fibonacci hash the rest
+  return ((p >> 3) * 2654435769u) >> (32 - __builtin_ctz(HEAP_TRACE_SLOTS));
+}
+
+static void track(void* ptr, size_t size) {
+  uint8_t tag = currentTag;
+  HeapTagStats& s = tagStats[tag];
+  if (!ptr) {
+    if (size) s.failures++;
+    return;
+  }
+  if (tracked >= HEAP_TRACE_SLOTS - 1) {
+    untracked++;     // Its free() is not seen either - keep it out of the totals
+    return;
+  }
+  uint16_t i = slotOf(addrOf(ptr));
+  while (slots[i].ptr) i = (i + 1) & (HEAP_TRACE_SLOTS - 1);
+  slots[i] = {addrOf(ptr), (uint16_t)size, tag};
+  if (++tracked > trackedPeak) trackedPeak = tracked;
+
+  s.allocs++;
+  s.liveBytes += size;
+  if (s.liveBytes > s.peakBytes) s.peakBytes = s.liveBytes;
+}
+
+/**
+ * Remove a block; linear probing with backward-shift delete (no tombstones)
+ */
+static void untrack(void* ptr) {
+  if (!ptr) return;
+  uint16_t i = slotOf(addrOf(ptr));
+  while (slots[i].ptr != addrOf(ptr)) {
+    if (!slots[i].ptr) return;          // Not ours (untracked or pre-trace)
+    i = (i + 1) & (HEAP_TRACE_SLOTS - 1);
+  }
+
+  HeapTagStats& s = tagStats[slots[i].tag];
+  s.frees++;
+  s.liveBytes -= slots[i].size;
+  tracked--;
+
+  uint16_t hole = i;
+  for (;;) {
+    i = (i + 1) & (HEAP_TRACE_SLOTS - 1);
+    if (!slots[i].ptr) break;
+    uint16_t home = slotOf(slots[i].ptr);
+    // Move back if the hole lies cyclically between home and i
+    if (((i - home) & (HEAP_TRACE_SLOTS - 1)) >= ((i - hole) & (HEAP_TRACE_SLOTS - 1))) {
+      slots[hole] = slots[i];
+      hole = i;
+    }
+  }
+  slots[hole].ptr = 0;
+}
+
+extern "C" {
+
+void* __wrap_malloc(size_t size) {
+  void* p = __real_malloc(size);
+  uint32_t ps = xt_rsil(15);
+  track(p, size);
+  xt_wsr_ps(ps);
+  return p;
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+  void* p = __real_calloc(n, size);
+  uint32_t ps = xt_rsil(15);
+  track(p, n * size);
+  xt_wsr_ps(ps);
+  return p;
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+  void* p = __real_realloc(ptr, size);
+  if (!p && size) {                     // Old block is still valid
+    uint32_t ps = xt_rsil(15);
+    tagStats[currentTag].failures++;
+    xt_wsr_ps(ps);
+    return p;
+  }
+  uint32_t ps = xt_rsil(15);
+  untrack(ptr);
+  if (size) track(p, size);
+  xt_wsr_ps(ps);
+  return p;
+}
+
+void __wrap_free(void* ptr) {
+  uint32_t ps = xt_rsil(15);
+  untrack(ptr);
+  xt_wsr_ps(ps);
+  __real_free(ptr);
+}
+
+}  // extern "C"
+
+HeapScope::HeapScope(HeapTag tag) : prev_(currentTag) {
+  maxBlockAtEntry_ = ESP.getMaxFreeBlockSize();
+  currentTag = tag;
+}
+
+HeapScope::~HeapScope() {
+  int32_t drop = (int32_t)maxBlockAtEntry_ - (int32_t)ESP.getMaxFreeBlockSize();
+  HeapTagStats& s = tagStats[currentTag];
+  if (drop > s.worstBlockDrop) s.worstBlockDrop = drop;
+  currentTag = prev_;
+}
+
+#endif  // HEAP_TRACE
+
+void heapTraceSample() {
+  uint32_t now = millis();
+  if (trendCount && now - lastSample < HEAP_TREND_MS) return;
+  lastSample = now;
+
+  trend[trendNext] = {now / 1000, (uint16_t)ESP.getFreeHeap(),
+                      (uint16_t)ESP.getMaxFreeBlockSize()};
+  trendNext = (trendNext + 1) % HEAP_TREND_SAMPLES;
+  if (trendCount < HEAP_TREND_SAMPLES) trendCount++;
+}
+
+const HeapTagStats& heapTraceStats(HeapTag tag) {
+  return tagStats[tag < HT_COUNT ? tag : HT_OTHER];
+}
+
+void heapTracePrint() {
+  CONSOLE("\n[HEAP] Allocation trace:\n");
+  CONSOLE("  Free: %lu B, largest block: %lu B, fragmentation: %u%%\n",
+          (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMaxFreeBlockSize(),
+          ESP.getHeapFragmentation());
+
+#ifdef HEAP_TRACE
+  CONSOLE("  Module        Live     Peak   Allocs    Frees  Fail  BlkDrop\n");
+  for (uint8_t t = 0; t < HT_COUNT; t++) {
+    const HeapTagStats& s = tagStats[t];
+    CONSOLE("  %-10s %7lu %8lu %8lu %8lu %5lu %8ld\n",
+            heapTagNames[t], (unsigned long)s.liveBytes, (unsigned long)s.peakBytes,
+            (unsigned long)s.allocs, (unsigned long)s.frees,
+            (unsigned long)s.failures, (long)s.worstBlockDrop);
+  }
+  CONSOLE("  Table: %u live blocks (peak %u of %u), %lu not attributed\n",
+          tracked, trackedPeak, HEAP_TRACE_SLOTS, (unsigned long)untracked);
+#else
+  CONSOLE("  Tracer not built in (add -D HEAP_TRACE and the --wrap flags)\n");
+#endif
+
+  if (trendCount) {
+    CONSOLE("  Trend (uptime s: free / largest block):\n");
+    uint8_t first = (trendNext + HEAP_TREND_SAMPLES - trendCount) % HEAP_TREND_SAMPLES;
+    for (uint8_t i = 0; i < trendCount; i++) {
+      const HeapSample& h = trend[(first + i) % HEAP_TREND_SAMPLES];
+      CONSOLE("    %lu: %u / %u\n", (unsigned long)h.at, h.freeBytes, h.maxBlock);
+    }
+  }
+}
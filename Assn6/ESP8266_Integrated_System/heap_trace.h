@@ -0,0 +1,89 @@
+// ============================================================================
+// heap_trace.h - Heap Allocation Tracer with Per-Module Attribution
+// ============================================================================
+// Purpose: Find out which code holds heap and fragments it (free heap was
+//          seen dropping from 42 KB to 14 KB)
+// Method: The linker redirects malloc/free/realloc/calloc to wrappers here
+//         (-Wl,--wrap=..., see platformio.ini); new/delete and String use
+//         malloc, so they are covered too. Every live block is kept in a
+//         fixed pointer hash table with its size and the module tag that
+//         was current when it was allocated. HEAP_SCOPE(tag) sets the tag
+//         for the rest of a block and restores the previous one on exit.
+// Per module: Live bytes, peak, allocation / free / failure counts and the
+//             worst drop of the largest free block across one of its scopes
+// Trend: Free heap and largest free block sampled every HEAP_TREND_MS
+// Disabled: Without -D HEAP_TRACE (and the --wrap flags) everything here
+//           compiles to nothing
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+/**
+ * Module tags. Untagged allocations (core, SDK callbacks, setup) are
+ * HT_OTHER. Keep heapTagNames in heap_trace.cpp in the same order.
+ */
+enum HeapTag : uint8_t {
+  HT_OTHER = 0,
+  HT_APP,           // Button pipelines, aggregation upload, anomalies
+  HT_NET,           // WiFi connect
+  HT_TIME,          // NTP / timestamps
+  HT_TX,            // Database uploads
+  HT_CONTROL,       // LED / RGB web control
+  HT_MESSAGING,     // Slack / SMS queue
+  HT_IFTTT,         // IFTTT alerts
+  HT_COUNT
+};
+
+#ifdef HEAP_TRACE
+
+/**
+ * Scoped tag guard - allocations until it goes out of scope are charged
+ * to tag (nesting restores the outer tag)
+ */
+class HeapScope {
+ public:
+  explicit HeapScope(HeapTag tag);
+  ~HeapScope();
+  HeapScope(const HeapScope&) = delete;
+  HeapScope& operator=(const HeapScope&) = delete;
+
+ private:
+  uint8_t prev_;
+  uint32_t maxBlockAtEntry_;
+};
+
+#define HEAP_SCOPE(tag) HeapScope heapScope_(tag)
+
+#else
+
+#define HEAP_SCOPE(tag) do {} while (0)
+
+#endif
+
+/**
+ * Per-module counters
+ */
+struct HeapTagStats {
+  uint32_t liveBytes;
+  uint32_t peakBytes;
+  uint32_t allocs;
+  uint32_t frees;
+  uint32_t failures;       // malloc returned NULL
+  int32_t worstBlockDrop;  // Largest-free-block decrease over one scope
+};
+
+/**
+ * Record a free heap / largest block sample (call periodically)
+ */
+void heapTraceSample();
+
+/**
+ * Get counters for one module
+ */
+const HeapTagStats& heapTraceStats(HeapTag tag);
+
+/**
+ * Print per-module table, trend and tracer health to Serial
+ */
+void heapTracePrint();
@@ -0,0 +1,132 @@
+// ============================================================================
+// inputs.cpp - Bit-Parallel Input Conditioning Implementation
+// ============================================================================
+// Vertical counter, per bit (cnt1:cnt0 counts disagreeing ticks, 0..3):
+//   delta  = sample ^ state          bits that disagree with the state
+//   cnt1   = (cnt1 ^ cnt0) & delta   counters of agreeing bits reset
+//   cnt0   = ~cnt0 & delta
+//   toggle = delta & ~(cnt0 | cnt1)  counter wrapped -> 4 ticks in a row
+//   state ^= toggle
+// ============================================================================
+
+#include "inputs.h"
+#include "config.h"
+#include "logger.h"
+#include "gpio_hal.h"
+#include "spsc_ring.h"
+#include "adc_acquire.h"
+#include "task_sched.h"
+
+static const uint8_t INPUT_BITS = 17;   // GPIO0..16
+
+static volatile uint32_t attached = 0;  // Bit n = GPIO n conditioned
+static volatile uint32_t activeLow = 0;
+static volatile uint32_t state = 0;     // Debounced, bit set = active
+static uint32_t cnt0 = 0, cnt1 = 0;
+static uint16_t holdTicks[INPUT_BITS];
+
+static uint32_t debounce = 0;          // Requested stable time (ms)
+static uint8_t decimation = 1;
+static uint8_t decimCount = 0;
+static uint16_t longTicks = 0;
+static uint16_t repeatTicks = 0;
+
+static SpscRing<InputEvent, INPUT_EVENT_RING> events;
+static InputStats stats = {0, 0, 0, 0};
+
+static void IRAM_ATTR emit(uint8_t pin, InputEventType type, uint32_t now) {
+  if (events.push({now, pin, type})) stats.events++;
+  else stats.dropped++;
+  schedWake();   // Handle it now rather than at the next input task tick
+}
+
+/**
+ * Hardware timer tick (ISR context)
+ */
+static void IRAM_ATTR inputsTick() {
+  if (++decimCount < decimation) return;
+  decimCount = 0;
+  stats.ticks++;
+
+  uint32_t mask = attached;
+  uint32_t sample = (gpioReadAll() ^ activeLow) & mask;
+
+  uint32_t delta = sample ^ state;
+  cnt1 = (cnt1 ^ cnt0) & delta;
+  cnt0 = ~cnt0 & delta;
+  uint32_t toggle = delta & ~(cnt0 | cnt1);
+  uint32_t now = millis();
+
+  if (toggle) {
+    uint32_t st = state ^ toggle;
+    state = st;
+    for (uint32_t t = toggle; t; t &= t - 1) {
+      uint8_t pin = __builtin_ctz(t);
+      holdTicks[pin] = 0;
+      emit(pin, (st >> pin) & 1 ? INPUT_EV_PRESS : INPUT_EV_RELEASE, now);
+    }
+  }
+
+  // Long press / repeat - only inputs that are held
+  for (uint32_t held = state & ~toggle; held; held &= held - 1) {
+    uint8_t pin = __builtin_ctz(held);
+    uint16_t h = holdTicks[pin];
+    if (h < 0xFFFF) holdTicks[pin] = ++h;
+    if (h == longTicks) {
+      emit(pin, INPUT_EV_LONG_PRESS, now);
+    } else if (h > longTicks && repeatTicks && (h - longTicks) % repeatTicks == 0) {
+      emit(pin, INPUT_EV_REPEAT, now);
+    }
+  }
+}
+
+void inputsBegin(uint32_t debounceMs) {
+  debounce = debounceMs;
+  inputsRetime();
+  adcAcqAddTickHook(inputsTick);
+}
+
+void inputsRetime() {
+  // 4 ticks per debounce time, in steps of the hardware tick (the timer
+  // may not be running yet at boot - it will start at ADC_SAMPLE_HZ)
+  uint16_t hz = adcAcqStats().rateHz;
+  uint32_t hwTickMs = 1000 / (hz ? hz : ADC_SAMPLE_HZ);
+  uint32_t d = (debounce / 4) / hwTickMs;
+
+  noInterrupts();
+  decimation = constrain(d, (uint32_t)1, (uint32_t)255);
+  decimCount = 0;
+  stats.tickMs = decimation * hwTickMs;
+  longTicks = INPUT_LONG_PRESS_MS / stats.tickMs;
+  repeatTicks = INPUT_REPEAT_MS / stats.tickMs;
+  interrupts();
+
+  LOGI("INPUTS", "Vertical-counter debounce, tick %u ms (%u ms stable)",
+       (unsigned)stats.tickMs, (unsigned)stats.tickMs * 4);
+}
+
+bool inputAttach(uint8_t pin, bool isActiveLow) {
+  if (pin >= INPUT_BITS || !gpioPinUsable(pin)) return false;
+  uint32_t bit = 1UL << pin;
+
+  noInterrupts();
+  if (isActiveLow) activeLow |= bit;
+  else activeLow &= ~bit;
+  // Start from the current level - no spurious press at boot
+  if ((gpioReadAll() ^ activeLow) & bit) state |= bit;
+  else state &= ~bit;
+  cnt0 &= ~bit;
+  cnt1 &= ~bit;
+  holdTicks[pin] = 0;
+  attached |= bit;
+  interrupts();
+  return true;
+}
+
+bool inputTakeEvent(InputEvent& out) {
+  return events.pop(out);
+}
+
+const InputStats& inputStats() {
+  return stats;
+}
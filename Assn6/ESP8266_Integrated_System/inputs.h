@@ -0,0 +1,65 @@
+// ============================================================================
+// inputs.h - Bit-Parallel Input Conditioning (Vertical-Counter Debouncer)
+// ============================================================================
+// Purpose: Debounce any number of digital inputs together and turn them
+//          into press / release / long-press / repeat events
+// Method: All pins are sampled with one GPI read (+ GP16I for GPIO16) into
+//         a word where bit n = GPIO n. Two "vertical" counter bit-planes
+//         debounce every bit at once: a bit toggles after 4 consecutive
+//         ticks of disagreement, in a handful of bitwise instructions no
+//         matter how many inputs are attached.
+// Tick: The timer0 hardware interrupt of adc_acquire (ADC_SAMPLE_HZ, or
+//       POWER_ADC_SAMPLE_HZ outside active mode), decimated so 4 ticks
+//       span the debounce time. Being a hardware
+//       interrupt, it keeps sampling while loop() is blocked, TLS included.
+// Adding an input: configure the pin (GpioPin<N>) and call inputAttach()
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+enum InputEventType : uint8_t {
+  INPUT_EV_PRESS = 0,
+  INPUT_EV_RELEASE,
+  INPUT_EV_LONG_PRESS,    // Held for INPUT_LONG_PRESS_MS
+  INPUT_EV_REPEAT         // Every INPUT_REPEAT_MS after a long press
+};
+
+struct InputEvent {
+  uint32_t timestamp;     // millis() of the debounced transition
+  uint8_t pin;
+  InputEventType type;
+};
+
+struct InputStats {
+  uint32_t ticks;
+  uint32_t events;
+  uint32_t dropped;       // Events lost to a full queue
+  uint16_t tickMs;
+};
+
+/**
+ * Start conditioning, hooks the timer tick
+ * @param debounceMs Time an input must be stable (4 ticks)
+ */
+void inputsBegin(uint32_t debounceMs);
+
+/**
+ * Re-derive the tick decimation after the timer0 rate changed
+ * (adcAcqSetRate), keeping the debounce time
+ */
+void inputsRetime();
+
+/**
+ * Add a pin (GPIO0-16, already configured as input)
+ * @param activeLow true if pressed = LOW (switch to GND with pull-up)
+ */
+bool inputAttach(uint8_t pin, bool activeLow = true);
+
+/**
+ * Take the oldest event
+ * @return false if none is queued
+ */
+bool inputTakeEvent(InputEvent& out);
+
+const InputStats& inputStats();
@@ -0,0 +1,405 @@
+// ============================================================================
+// kvstore.cpp - Wear-Leveled Key-Value Store Implementation
+// ============================================================================
+// Layout: KV_SECTOR_COUNT flash sectors at the top of the FS region.
+//   Each sector = [SectorHeader][Record][Record]...[erased 0xFF]
+//   Record      = [key][len][crc16][data padded to 4 bytes]
+// Updates append a new record; the newest record of a key wins. When the
+// active sector is full, the live values are copied into the next sector
+// (round-robin, so erases are spread evenly) and its header is written
+// last, which commits the rotation atomically.
+// ============================================================================
+
+#include "kvstore.h"
+#include "config.h"
+#include "logger.h"
+#include "adc_acquire.h"
+#include <flash_hal.h>
+
+static const uint32_t KV_MAGIC = 0x4B565331;   // "KVS1"
+
+struct SectorHeader {
+  uint32_t magic;
+  uint32_t seq;          // Incremented on every rotation, highest = newest
+  uint32_t eraseCount;   // Times this sector has been erased
+  uint16_t crc;
+  uint16_t reserved;
+};
+
+struct RecordHeader {
+  uint8_t key;
+  uint8_t len;
+  uint16_t crc;
+};
+
+// Maximum value size per key (index = KvKey)
+static constexpr uint8_t keyMaxLen[KV_KEY_COUNT] = {
+  0,                // unused (key 0)
+  TZ_EEPROM_SIZE - 1, // KV_TIMEZONE (stored without the terminator)
+  4,                // KV_SWITCH1_COUNT
+  4,                // KV_SWITCH2_COUNT
+  1,                // KV_WIFI_CHANNEL
+  6,                // KV_WIFI_BSSID
+  4,                // KV_AUTO_POLL_MS
+  4,                // KV_DEBOUNCE_MS
+  4,                // KV_AGG_WINDOW_MS
+  1                 // KV_POWER_MODE
+};
+
+static constexpr size_t pad4(size_t n) { return (n + 3) & ~(size_t)3; }
+
+static constexpr size_t cacheBytes() {
+  size_t n = 0;
+  for (uint8_t key = 1; key < KV_KEY_COUNT; key++) n += keyMaxLen[key];
+  return n;
+}
+
+static constexpr size_t maxRecordBytes() {
+  size_t n = 0;
+  for (uint8_t key = 1; key < KV_KEY_COUNT; key++) n += sizeof(RecordHeader) + pad4(keyMaxLen[key]);
+  return n;
+}
+
+static_assert(sizeof(SectorHeader) == 16, "SectorHeader must stay 16 bytes");
+static_assert(sizeof(RecordHeader) == 4, "RecordHeader must stay 4 bytes");
+static_assert(KV_SECTOR_COUNT >= 2 && KV_SECTOR_COUNT <= 8, "KV_SECTOR_COUNT must be 2..8");
+static_assert(sizeof(SectorHeader) + maxRecordBytes() < FLASH_SECTOR_SIZE / 2,
+              "Live KV data must fit comfortably in one sector");
+
+// RAM read-through cache
+static uint8_t cache[cacheBytes()];
+static uint8_t cacheLen[KV_KEY_COUNT];   // 0 = key not present
+static uint16_t cacheOffset[KV_KEY_COUNT];
+
+// Flash state
+static bool flashOk = false;
+static uint32_t regionAddr = 0;
+static uint8_t activeSector = 0;
+static uint32_t activeSeq = 0;
+static uint32_t writeOffset = 0;
+static uint32_t eraseCount[KV_SECTOR_COUNT];
+
+static KvStats stats;
+
+/**
+ * CRC-16/CCITT-FALSE
+ */
+static uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF) {
+  for (size_t i = 0; i < len; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+static uint16_t recordCrc(uint8_t key, uint8_t len, const uint8_t* data) {
+  uint8_t hdr[2] = {key, len};
+  return crc16(data, len, crc16(hdr, 2));
+}
+
+static uint16_t headerCrc(const SectorHeader& h) {
+  return crc16((const uint8_t*)&h, offsetof(SectorHeader, crc));
+}
+
+static uint32_t sectorAddr(uint8_t sector) {
+  return regionAddr + (uint32_t)sector * FLASH_SECTOR_SIZE;
+}
+
+// The ADC timer ISR converts through SDK code in flash, so conversions are
+// paused while the SDK turns the flash cache off for read/erase/write
+static bool flashRead(uint32_t addr, void* dst, size_t len) {
+  adcAcqSuspend();
+  bool ok = flash_hal_read(addr, len, (uint8_t*)dst) == FLASH_HAL_OK;
+  adcAcqResume();
+  return ok;
+}
+
+static bool flashWrite(uint32_t addr, const void* src, size_t len) {
+  adcAcqSuspend();
+  bool ok = flash_hal_write(addr, len, (const uint8_t*)src) == FLASH_HAL_OK;
+  adcAcqResume();
+  if (!ok) return false;
+  stats.flashBytes += len;
+  return true;
+}
+
+static bool flashErase(uint8_t sector) {
+  adcAcqSuspend();
+  bool ok = flash_hal_erase(sectorAddr(sector), FLASH_SECTOR_SIZE) == FLASH_HAL_OK;
+  adcAcqResume();
+  if (!ok) return false;
+  eraseCount[sector]++;
+  return true;
+}
+
+static bool validKey(uint8_t key) {
+  return key > 0 && key < KV_KEY_COUNT;
+}
+
+/**
+ * Append one record at the given offset of a sector
+ */
+static bool writeRecord(uint8_t sector, uint32_t offset, uint8_t key,
+                        const uint8_t* data, uint8_t len) {
+  uint32_t buf[(sizeof(RecordHeader) + 255 + 3) / 4];
+  uint8_t* p = (uint8_t*)buf;
+  size_t total = sizeof(RecordHeader) + pad4(len);
+
+  RecordHeader hdr = {key, len, recordCrc(key, len, data)};
+  memcpy(p, &hdr, sizeof(hdr));
+  memcpy(p + sizeof(hdr), data, len);
+  memset(p + sizeof(hdr) + len, 0xFF, total - sizeof(hdr) - len);
+
+  return flashWrite(sectorAddr(sector) + offset, buf, total);
+}
+
+/**
+ * Copy all live values into the next sector, then commit its header.
+ * The old sector stays valid until the new header is written.
+ */
+static bool compact() {
+  uint8_t next = (activeSector + 1) % KV_SECTOR_COUNT;
+
+  if (!flashErase(next)) {
+    LOGE("KV", "Sector erase failed (-41)");
+    return false;
+  }
+
+  uint32_t offset = sizeof(SectorHeader);
+  for (uint8_t key = 1; key < KV_KEY_COUNT; key++) {
+    if (cacheLen[key] == 0) continue;
+    if (!writeRecord(next, offset, key, cache + cacheOffset[key], cacheLen[key])) {
+      LOGE("KV", "Compaction write failed (-42)");
+      return false;
+    }
+    offset += sizeof(RecordHeader) + pad4(cacheLen[key]);
+  }
+
+  SectorHeader hdr = {KV_MAGIC, activeSeq + 1, eraseCount[next], 0, 0xFFFF};
+  hdr.crc = headerCrc(hdr);
+  if (!flashWrite(sectorAddr(next), &hdr, sizeof(hdr))) {
+    LOGE("KV", "Header write failed (-43)");
+    return false;
+  }
+
+  activeSector = next;
+  activeSeq = hdr.seq;
+  writeOffset = offset;
+  stats.compactions++;
+  return true;
+}
+
+/**
+ * Replay the log of the active sector into the cache.
+ * Returns false if the sector tail is not clean (torn write) and needs
+ * to be compacted before appending again.
+ */
+static bool replaySector(uint8_t sector) {
+  uint32_t offset = sizeof(SectorHeader);
+  uint8_t data[255];
+
+  while (offset + sizeof(RecordHeader) <= FLASH_SECTOR_SIZE) {
+    RecordHeader hdr;
+    if (!flashRead(sectorAddr(sector) + offset, &hdr, sizeof(hdr))) return false;
+
+    if (hdr.key == 0xFF && hdr.len == 0xFF && hdr.crc == 0xFFFF) break;  // End of log
+
+    if (!validKey(hdr.key) || hdr.len == 0 || hdr.len > keyMaxLen[hdr.key] ||
+        offset + sizeof(hdr) + pad4(hdr.len) > FLASH_SECTOR_SIZE) {
+      stats.crcErrors++;
+      writeOffset = offset;
+      return false;
+    }
+
+    if (!flashRead(sectorAddr(sector) + offset + sizeof(hdr), data, hdr.len)) return false;
+
+    if (recordCrc(hdr.key, hdr.len, data) == hdr.crc) {
+      memcpy(cache + cacheOffset[hdr.key], data, hdr.len);
+      cacheLen[hdr.key] = hdr.len;
+    } else {
+      stats.crcErrors++;
+    }
+    offset += sizeof(hdr) + pad4(hdr.len);
+  }
+  writeOffset = offset;
+
+  // Everything after the last record must still be erased
+  uint32_t words[16];
+  for (uint32_t a = offset; a < FLASH_SECTOR_SIZE; a += sizeof(words)) {
+    size_t n = min((uint32_t)sizeof(words), FLASH_SECTOR_SIZE - a);
+    if (!flashRead(sectorAddr(sector) + a, words, n)) return false;
+    for (size_t i = 0; i < n / 4; i++) {
+      if (words[i] != 0xFFFFFFFF) return false;
+    }
+  }
+  return true;
+}
+
+bool kvBegin() {
+  uint16_t off = 0;
+  for (uint8_t key = 1; key < KV_KEY_COUNT; key++) {
+    cacheOffset[key] = off;
+    cacheLen[key] = 0;
+    off += keyMaxLen[key];
+  }
+  memset(&stats, 0, sizeof(stats));
+  stats.sectorCount = KV_SECTOR_COUNT;
+
+  if (FS_PHYS_SIZE < (uint32_t)KV_SECTOR_COUNT * FLASH_SECTOR_SIZE) {
+    LOGE("KV", "No flash region (FS size too small) - RAM only (-40)");
+    flashOk = false;
+    return false;
+  }
+  regionAddr = FS_PHYS_ADDR + FS_PHYS_SIZE - (uint32_t)KV_SECTOR_COUNT * FLASH_SECTOR_SIZE;
+  flashOk = true;
+
+  // Find the newest valid sector
+  bool found = false;
+  for (uint8_t s = 0; s < KV_SECTOR_COUNT; s++) {
+    SectorHeader hdr;
+    eraseCount[s] = 0;
+    if (!flashRead(sectorAddr(s), &hdr, sizeof(hdr))) continue;
+    if (hdr.magic != KV_MAGIC || hdr.crc != headerCrc(hdr)) continue;
+    eraseCount[s] = hdr.eraseCount;
+    if (!found || (int32_t)(hdr.seq - activeSeq) > 0) {
+      activeSector = s;
+      activeSeq = hdr.seq;
+      found = true;
+    }
+  }
+
+  if (!found) {
+    // Blank region: format the last sector so the first rotation lands on 0
+    LOGW("KV", "No valid store found - formatting");
+    activeSector = KV_SECTOR_COUNT - 1;
+    activeSeq = 0;
+    if (!compact()) {
+      flashOk = false;
+      return false;
+    }
+    stats.compactions = 0;
+  } else if (!replaySector(activeSector)) {
+    LOGW("KV", "Torn write detected - compacting");
+    if (!compact()) {
+      flashOk = false;
+      return false;
+    }
+  }
+
+  LOGI("KV", "Mounted sector %u (seq %lu, %lu bytes used)", activeSector,
+       (unsigned long)activeSeq, (unsigned long)writeOffset);
+  return true;
+}
+
+uint8_t kvGet(KvKey key, void* out, uint8_t len) {
+  if (!validKey(key) || cacheLen[key] == 0) return 0;
+  uint8_t n = min(len, cacheLen[key]);
+  memcpy(out, cache + cacheOffset[key], n);
+  return n;
+}
+
+bool kvHas(KvKey key) {
+  return validKey(key) && cacheLen[key] > 0;
+}
+
+bool kvPut(KvKey key, const void* data, uint8_t len) {
+  if (!validKey(key) || len == 0 || len > keyMaxLen[key]) return false;
+
+  uint8_t* slot = cache + cacheOffset[key];
+  if (cacheLen[key] == len && memcmp(slot, data, len) == 0) {
+    stats.unchanged++;
+    return true;
+  }
+
+  stats.userBytes += len;
+
+  if (!flashOk) {
+    memcpy(slot, data, len);
+    cacheLen[key] = len;
+    return true;
+  }
+
+  size_t recSize = sizeof(RecordHeader) + pad4(len);
+  if (writeOffset + recSize > FLASH_SECTOR_SIZE) {
+    // Rotate: the new value is written as part of the compacted log
+    uint8_t oldVal[255];
+    uint8_t oldLen = cacheLen[key];
+    memcpy(oldVal, slot, oldLen);
+    memcpy(slot, data, len);
+    cacheLen[key] = len;
+    if (!compact()) {
+      memcpy(slot, oldVal, oldLen);
+      cacheLen[key] = oldLen;
+      return false;
+    }
+    stats.records++;
+    return true;
+  }
+
+  if (!writeRecord(activeSector, writeOffset, key, (const uint8_t*)data, len)) {
+    LOGE("KV", "Record write failed (-44)");
+    // Offset is no longer known to be clean; rotate on next put
+    writeOffset = FLASH_SECTOR_SIZE;
+    return false;
+  }
+  writeOffset += recSize;
+  stats.records++;
+
+  memcpy(slot, data, len);
+  cacheLen[key] = len;
+  return true;
+}
+
+uint32_t kvGetU32(KvKey key, uint32_t defaultValue) {
+  uint32_t v;
+  return (kvGet(key, &v, sizeof(v)) == sizeof(v)) ? v : defaultValue;
+}
+
+bool kvPutU32(KvKey key, uint32_t value) {
+  return kvPut(key, &value, sizeof(value));
+}
+
+bool kvGetString(KvKey key, char* out, size_t size) {
+  if (size == 0) return false;
+  uint8_t n = kvGet(key, out, (uint8_t)min(size - 1, (size_t)255));
+  out[n] = '\0';
+  return n > 0;
+}
+
+bool kvPutString(KvKey key, const char* s) {
+  size_t n = strlen(s);
+  if (n == 0 || n > 255) return false;
+  return kvPut(key, s, (uint8_t)n);
+}
+
+const KvStats& kvStats() {
+  for (uint8_t s = 0; s < KV_SECTOR_COUNT; s++) {
+    stats.sectorErases[s] = eraseCount[s];
+  }
+  stats.activeSector = activeSector;
+  stats.activeUsed = (uint16_t)min(writeOffset, (uint32_t)FLASH_SECTOR_SIZE);
+  return stats;
+}
+
+void kvPrintStats() {
+  const KvStats& st = kvStats();
+
+  CONSOLE("\n[KV] Store statistics:\n");
+  CONSOLE("  Flash:      %s\n", flashOk ? "OK" : "RAM only");
+  CONSOLE("  Active:     sector %u, %u/%u bytes\n",
+          st.activeSector, st.activeUsed, (unsigned)FLASH_SECTOR_SIZE);
+  CONSOLE("  Records:    %lu (%lu unchanged puts skipped)\n",
+          (unsigned long)st.records, (unsigned long)st.unchanged);
+  CONSOLE("  User bytes: %lu\n", (unsigned long)st.userBytes);
+  CONSOLE("  Flash bytes:%lu\n", (unsigned long)st.flashBytes);
+  CONSOLE("  Write amp:  %.2f\n", st.userBytes ? (float)st.flashBytes / st.userBytes : 0.0f);
+  CONSOLE("  Rotations:  %lu\n", (unsigned long)st.compactions);
+  CONSOLE("  CRC errors: %lu\n", (unsigned long)st.crcErrors);
+  CONSOLE("  Erases:    ");
+  for (uint8_t s = 0; s < st.sectorCount; s++) {
+    CONSOLE(" %lu", (unsigned long)st.sectorErases[s]);
+  }
+  CONSOLE("\n");
+}
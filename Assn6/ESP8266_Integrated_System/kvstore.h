@@ -0,0 +1,91 @@
+// ============================================================================
+// kvstore.h - Wear-Leveled Key-Value Configuration Store
+// ============================================================================
+// Purpose: Persist small configuration values and counters in flash
+// Features: Log-structured records, per-record CRC, sector rotation
+//           (wear leveling), RAM read-through cache, write statistics
+// Replaces: Raw EEPROM.write()/commit() of the timezone string
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+/**
+ * Keys stored in the KV log. Values are written as raw bytes; the maximum
+ * size of each key is fixed in kvstore.cpp. Never renumber existing keys -
+ * the numbers are what is stored in flash.
+ */
+enum KvKey : uint8_t {
+  KV_TIMEZONE       = 1,   // IANA timezone string
+  KV_SWITCH1_COUNT  = 2,   // uint32_t activity counter (Button 1)
+  KV_SWITCH2_COUNT  = 3,   // uint32_t activity counter (Button 2)
+  KV_WIFI_CHANNEL   = 4,   // uint8_t  last AP channel (fast reconnect)
+  KV_WIFI_BSSID     = 5,   // uint8_t[6] last AP BSSID (fast reconnect)
+  KV_AUTO_POLL_MS   = 6,   // uint32_t web command poll interval
+  KV_DEBOUNCE_MS    = 7,   // uint32_t switch debounce time
+  KV_AGG_WINDOW_MS  = 8,   // uint32_t aggregation window length
+  KV_POWER_MODE     = 9,   // uint8_t  PowerMode (power.h)
+  KV_KEY_COUNT
+};
+
+/**
+ * Write/erase statistics for wear monitoring
+ */
+struct KvStats {
+  uint32_t userBytes;      // Value bytes requested by kvPut()
+  uint32_t flashBytes;     // Bytes physically written to flash
+  uint32_t records;        // Records appended
+  uint32_t unchanged;      // kvPut() calls skipped (value identical)
+  uint32_t compactions;    // Sector rotations
+  uint32_t crcErrors;      // Corrupt records found while mounting
+  uint32_t sectorErases[8];
+  uint8_t  sectorCount;
+  uint8_t  activeSector;
+  uint16_t activeUsed;     // Bytes used in the active sector
+};
+
+/**
+ * Mount the store: locate the newest sector, replay its log into the RAM
+ * cache. Falls back to RAM-only operation if no flash region is available.
+ * Returns true if flash persistence is available.
+ */
+bool kvBegin();
+
+/**
+ * Read a value from the RAM cache (no flash access)
+ * @param key Key to read
+ * @param out Destination buffer
+ * @param len Size of destination buffer
+ * @return Number of bytes copied, 0 if key not present
+ */
+uint8_t kvGet(KvKey key, void* out, uint8_t len);
+
+/**
+ * Append a new value for a key. Writing an identical value is a no-op.
+ * The update is atomic: a power loss leaves either the old or new value.
+ * @return true if value is stored (or unchanged)
+ */
+bool kvPut(KvKey key, const void* data, uint8_t len);
+
+/**
+ * Check whether a key currently has a value
+ */
+bool kvHas(KvKey key);
+
+/**
+ * Convenience helpers for numeric and string values
+ */
+uint32_t kvGetU32(KvKey key, uint32_t defaultValue);
+bool kvPutU32(KvKey key, uint32_t value);
+bool kvGetString(KvKey key, char* out, size_t size);
+bool kvPutString(KvKey key, const char* s);
+
+/**
+ * Get write statistics (write amplification = flashBytes / userBytes)
+ */
+const KvStats& kvStats();
+
+/**
+ * Print statistics to Serial
+ */
+void kvPrintStats();
@@ -0,0 +1,170 @@
+// ============================================================================
+// ledfx.cpp - Timer-Driven LED Effect Engine Implementation
+// ============================================================================
+// service() runs on every timer0 tick (ISR context, adc_acquire.h), so the
+// channel table is shared with the interrupt: the loop-side calls change it
+// with interrupts off, and everything the tick reaches is IRAM_ATTR or
+// inline (gpioWrite() is one register store).
+// ============================================================================
+
+#include "ledfx.h"
+#include "config.h"
+#include "gpio_hal.h"
+#include "adc_acquire.h"
+
+struct LedChannel {
+  uint8_t pin;
+  bool activeHigh;
+  bool hold;            // Steady level (restored after an effect)
+  bool output;          // Level currently on the pin
+  LedEffect effect;
+  uint32_t bits;        // Effect pattern, MSB first
+  uint8_t length;       // Bits in the pattern
+  uint16_t stepMs;
+  uint32_t stepsLeft;   // 0 = endless
+  uint8_t index;        // Current bit
+  uint32_t nextAt;      // millis() of the next transition
+};
+
+static LedChannel channels[LED_FX_MAX_CHANNELS];
+static volatile uint8_t channelCount = 0;
+static_assert(LED_FX_MAX_CHANNELS <= 8, "One runningMask bit per channel");
+static volatile uint8_t runningMask = 0;   // Bit n = channel n has an effect
+static LedFxStats stats = {0, 0};
+
+/**
+ * Drive the pin only if the level changes
+ */
+static void IRAM_ATTR setOutput(LedChannel& c, bool on) {
+  if (c.output == on) return;
+  c.output = on;
+  gpioWrite(c.pin, on == c.activeHigh);
+  stats.writes++;
+}
+
+static bool IRAM_ATTR patternBit(const LedChannel& c) {
+  return (c.bits >> (c.length - 1 - c.index)) & 1;
+}
+
+/**
+ * Advance one channel to its next step, or finish the effect
+ */
+static void IRAM_ATTR stepChannel(uint8_t ch) {
+  LedChannel& c = channels[ch];
+  if (c.stepsLeft && --c.stepsLeft == 0) {
+    c.effect = LED_FX_HOLD;
+    runningMask &= ~(1 << ch);
+    setOutput(c, c.hold);
+    return;
+  }
+  c.index = (c.index + 1 == c.length) ? 0 : c.index + 1;
+  c.nextAt += c.stepMs;
+  setOutput(c, patternBit(c));
+}
+
+/**
+ * timer0 tick hook - apply every transition that is due
+ */
+static void IRAM_ATTR service() {
+  uint8_t mask = runningMask;
+  if (!mask) return;
+  uint32_t now = millis();
+  bool stepped = false;
+  for (uint8_t i = 0; i < channelCount; i++) {
+    if (!(mask & (1 << i))) continue;
+    LedChannel& c = channels[i];
+    // More than one step if the tick is coarser than the effect
+    while (c.effect != LED_FX_HOLD && (int32_t)(now - c.nextAt) >= 0) {
+      stepChannel(i);
+      stepped = true;
+    }
+  }
+  if (stepped) stats.wakeups++;
+}
+
+/**
+ * Start a pattern effect on a channel
+ */
+static void startEffect(int8_t ch, LedEffect fx, uint32_t bits, uint8_t length,
+                        uint16_t stepMs, uint32_t steps) {
+  if (ch < 0 || ch >= channelCount || length == 0 || length > 32 || stepMs == 0) return;
+  LedChannel& c = channels[ch];
+  noInterrupts();
+  c.effect = fx;
+  c.bits = bits;
+  c.length = length;
+  c.stepMs = stepMs;
+  c.stepsLeft = steps;
+  c.index = 0;
+  c.nextAt = millis() + stepMs;
+  setOutput(c, patternBit(c));
+  runningMask |= 1 << ch;
+  interrupts();
+}
+
+int8_t ledFxAttach(uint8_t pin, bool activeHigh) {
+  int8_t existing = ledFxChannel(pin);
+  if (existing >= 0) return existing;
+  if (channelCount >= LED_FX_MAX_CHANNELS) return -1;
+
+  if (channelCount == 0 && !adcAcqAddTickHook(service)) return -1;
+
+  LedChannel& c = channels[channelCount];
+  c = {pin, activeHigh, false, true, LED_FX_HOLD, 0, 0, 0, 0, 0, 0};
+  pinMode(pin, OUTPUT);
+  setOutput(c, false);
+  return channelCount++;   // Visible to the tick only once it is set up
+}
+
+int8_t ledFxChannel(uint8_t pin) {
+  for (uint8_t i = 0; i < channelCount; i++) {
+    if (channels[i].pin == pin) return i;
+  }
+  return -1;
+}
+
+void ledFxHold(int8_t ch, bool on) {
+  if (ch < 0 || ch >= channelCount) return;
+  LedChannel& c = channels[ch];
+  noInterrupts();
+  c.hold = on;
+  if (c.effect == LED_FX_HOLD) setOutput(c, on);
+  interrupts();
+}
+
+void ledFxBlink(int8_t ch, uint16_t period_ms, uint32_t duration_ms) {
+  uint32_t steps = period_ms ? (duration_ms + period_ms - 1) / period_ms : 0;
+  if (duration_ms && steps == 0) return;
+  startEffect(ch, LED_FX_BLINK, 0b10, 2, period_ms, steps);
+}
+
+void ledFxPulse(int8_t ch, uint16_t on_ms) {
+  startEffect(ch, LED_FX_PULSE, 0b1, 1, on_ms, 1);
+}
+
+void ledFxPattern(int8_t ch, uint32_t bits, uint8_t length, uint16_t step_ms,
+                  uint8_t repeats) {
+  startEffect(ch, LED_FX_PATTERN, bits, length, step_ms, (uint32_t)repeats * length);
+}
+
+void ledFxStop(int8_t ch) {
+  if (ch < 0 || ch >= channelCount) return;
+  LedChannel& c = channels[ch];
+  noInterrupts();
+  c.effect = LED_FX_HOLD;
+  runningMask &= ~(1 << ch);
+  setOutput(c, c.hold);
+  interrupts();
+}
+
+bool ledFxLevel(int8_t ch) {
+  return (ch >= 0 && ch < channelCount) ? channels[ch].hold : false;
+}
+
+LedEffect ledFxEffect(int8_t ch) {
+  return (ch >= 0 && ch < channelCount) ? channels[ch].effect : LED_FX_HOLD;
+}
+
+const LedFxStats& ledFxStats() {
+  return stats;
+}
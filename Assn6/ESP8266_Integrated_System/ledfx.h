@@ -0,0 +1,86 @@
+// ============================================================================
+// ledfx.h - Timer-Driven LED Effect Engine
+// ============================================================================
+// Purpose: Run blink/pulse/pattern effects on any number of digital LEDs
+//          without loop() polling
+// Method: One table of channels, stepped from the timer0 tick interrupt
+//         (adc_acquire.h tick hook). Every effect is a bit pattern played
+//         step by step; GPIO is written only on edges. Because it runs in
+//         the ISR, effects keep their timing while loop() is blocked in
+//         network I/O (TLS handshakes included). Step times are rounded up
+//         to the tick: 5 ms at ADC_SAMPLE_HZ, 20 ms outside active mode.
+//         Needs the ADC timer running (started by the light sensor).
+// Effects: HOLD (steady level), BLINK (on/off for a duration),
+//          PULSE (single on-pulse), PATTERN (bit sequence, repeated)
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+enum LedEffect : uint8_t {
+  LED_FX_HOLD = 0,
+  LED_FX_BLINK,
+  LED_FX_PULSE,
+  LED_FX_PATTERN
+};
+
+/**
+ * Engine counters
+ */
+struct LedFxStats {
+  uint32_t wakeups;       // Ticks that applied a transition
+  uint32_t writes;        // GPIO writes (edges only)
+};
+
+/**
+ * Add an LED to the channel table and drive it to its off level
+ * @param pin GPIO of the LED
+ * @param activeHigh false for LEDs wired to VCC
+ * @return Channel id, or -1 if LED_FX_MAX_CHANNELS is reached
+ */
+int8_t ledFxAttach(uint8_t pin, bool activeHigh = true);
+
+/**
+ * Find the channel of a pin
+ * @return Channel id, or -1 if the pin is not attached
+ */
+int8_t ledFxChannel(uint8_t pin);
+
+/**
+ * Set the steady level. A running effect finishes first and then
+ * returns to this level.
+ */
+void ledFxHold(int8_t ch, bool on);
+
+/**
+ * Toggle every period_ms for duration_ms (0 = until stopped)
+ */
+void ledFxBlink(int8_t ch, uint16_t period_ms, uint32_t duration_ms);
+
+/**
+ * Turn on once for on_ms
+ */
+void ledFxPulse(int8_t ch, uint16_t on_ms);
+
+/**
+ * Play a bit pattern, MSB first: bit set = on
+ * @param bits Pattern (up to 32 steps)
+ * @param length Number of valid bits in the pattern
+ * @param step_ms Duration of one bit
+ * @param repeats Number of plays (0 = until stopped)
+ */
+void ledFxPattern(int8_t ch, uint32_t bits, uint8_t length, uint16_t step_ms,
+                  uint8_t repeats);
+
+/**
+ * Cancel the running effect, return to the steady level
+ */
+void ledFxStop(int8_t ch);
+
+/**
+ * Steady level and effect state of a channel
+ */
+bool ledFxLevel(int8_t ch);
+LedEffect ledFxEffect(int8_t ch);
+
+const LedFxStats& ledFxStats();
@@ -1,117 +1,122 @@
 // ============================================================================
 // leds.cpp - LED and RGB Control Implementation
 // ============================================================================
+// The RGB fade is NOT independent of loop(): it steps on a Ticker. Moving it
+// onto the timer0 tick like the LED effects (ledfx.cpp) would need a duty
+// update that is safe in an ISR, and analogWrite() is not - it runs from
+// flash (the tick also fires during flash writes) and hands the new duty
+// to the timer1 waveform interrupt, then waits for that interrupt to take it.
+// ============================================================================
 
 #include "leds.h"
 #include "config.h"
+#include "logger.h"
+#include "ledfx.h"
+#include "gamma.h"
+#include <Ticker.h>
 
-// Blink state for non-blocking animation
-struct BlinkState {
-  uint8_t pin;
-  uint32_t startTime;
-  uint16_t blinkPeriod;
-  uint16_t duration;
-  bool active;
-};
-
-static BlinkState blink1 = {PIN_LED1, 0, 0, 0, false};
-static BlinkState blink2 = {PIN_LED2, 0, 0, 0, false};
+static constexpr GammaLut GAMMA PROGMEM = gammaMakeTable();
+static_assert(GAMMA.duty[0] == 0, "Gamma table must start dark");
+static_assert(GAMMA.duty[GAMMA_MAX] == GAMMA_MAX, "Gamma table must end at full duty");
 
-// Current LED states
-static bool led1State = false;
-static bool led2State = false;
+static const uint8_t rgbPins[3] = {RGB_RED_PIN, RGB_GREEN_PIN, RGB_BLUE_PIN};
 
-// Current RGB values
+// Current RGB values (target colour, 0-255)
 static int rgbR = 0, rgbG = 0, rgbB = 0;
 
+// Fade state, in 10-bit perceptual levels
+static uint16_t fadeFrom[3] = {0, 0, 0};
+static uint16_t fadeTo[3] = {0, 0, 0};
+static uint16_t levelNow[3] = {0, 0, 0};
+static uint16_t dutyNow[3] = {0xFFFF, 0xFFFF, 0xFFFF};   // Forces the first write
+static uint32_t fadeStart = 0;
+static uint16_t fadeMs = 0;
+static Ticker fadeTimer;
+
 /**
- * Initialize all LED pins
+ * Output a 10-bit level on one channel (PWM updated only on change)
  */
-void ledsBegin() {
-  // Digital LEDs
-  pinMode(PIN_LED1, OUTPUT);
-  pinMode(PIN_LED2, OUTPUT);
-  digitalWrite(PIN_LED1, LOW);
-  digitalWrite(PIN_LED2, LOW);
-  
-  // RGB LED (PWM pins)
-  pinMode(RGB_RED_PIN, OUTPUT);
-  pinMode(RGB_GREEN_PIN, OUTPUT);
-  pinMode(RGB_BLUE_PIN, OUTPUT);
-  setRGBColor(0, 0, 0);  // Start with RGB off
-  
-  Serial.println("[LEDS] Initialized:");
-  Serial.println("  LED1 (GPIO12) | LED2 (GPIO13)");
-  Serial.println("  RGB: R=GPIO15, G=GPIO4, B=GPIO5");
+static void writeLevel(uint8_t i, uint16_t level) {
+  levelNow[i] = level;
+  uint16_t duty = pgm_read_word(&GAMMA.duty[level]);
+  if (duty == dutyNow[i]) return;
+  dutyNow[i] = duty;
+  analogWrite(rgbPins[i], duty);
 }
 
 /**
- * Helper to handle one blink state
+ * Fade step (Ticker, runs only when loop() yields) - position follows
+ * elapsed time, not tick count, so a stall does not stretch the fade
  */
-static void handleBlink(BlinkState& bs) {
-  if (!bs.active) return;
-  
-  uint32_t elapsed = millis() - bs.startTime;
-  
-  if (elapsed >= bs.duration) {
-    // Blink sequence complete - restore original state
-    bs.active = false;
-    if (bs.pin == PIN_LED1) {
-      digitalWrite(PIN_LED1, led1State ? HIGH : LOW);
-    } else if (bs.pin == PIN_LED2) {
-      digitalWrite(PIN_LED2, led2State ? HIGH : LOW);
-    }
+static void fadeStep() {
+  uint32_t elapsed = millis() - fadeStart;
+  if (elapsed >= fadeMs) {
+    for (uint8_t i = 0; i < 3; i++) writeLevel(i, fadeTo[i]);
+    fadeTimer.detach();
     return;
   }
-  
-  // Toggle based on blink period
-  uint16_t phase = elapsed % (bs.blinkPeriod * 2);
-  bool blinkOn = (phase < bs.blinkPeriod);
-  digitalWrite(bs.pin, blinkOn ? HIGH : LOW);
+  for (uint8_t i = 0; i < 3; i++) {
+    int32_t delta = (int32_t)fadeTo[i] - fadeFrom[i];
+    writeLevel(i, fadeFrom[i] + delta * (int32_t)elapsed / fadeMs);
+  }
 }
 
 /**
- * Poll all blink states (non-blocking)
+ * Initialize all LED pins
  */
-void ledsPoll() {
-  handleBlink(blink1);
-  handleBlink(blink2);
+void ledsBegin() {
+  // Digital LEDs - driven by the effect engine
+  ledFxAttach(PIN_LED1);
+  ledFxAttach(PIN_LED2);
+  
+  // RGB LED (PWM pins) - core 3.x defaults to a 0-255 range
+  analogWriteRange(GAMMA_MAX);
+  pinMode(RGB_RED_PIN, OUTPUT);
+  pinMode(RGB_GREEN_PIN, OUTPUT);
+  pinMode(RGB_BLUE_PIN, OUTPUT);
+  setRGBColor(0, 0, 0);  // Start with RGB off
+  
+  LOGI("LEDS", "Initialized: LED1 (GPIO%u) | LED2 (GPIO%u) | RGB R=GPIO%u, G=GPIO%u, B=GPIO%u",
+       PIN_LED1, PIN_LED2, RGB_RED_PIN, RGB_GREEN_PIN, RGB_BLUE_PIN);
 }
 
 /**
  * Start async blink on specified pin
  */
 void blinkAsync(uint8_t pin, uint16_t blink_ms, uint16_t duration_ms) {
-  BlinkState* bs = nullptr;
-  
-  if (pin == PIN_LED1) {
-    bs = &blink1;
-  } else if (pin == PIN_LED2) {
-    bs = &blink2;
-  }
-  
-  if (bs) {
-    bs->pin = pin;
-    bs->startTime = millis();
-    bs->blinkPeriod = blink_ms;
-    bs->duration = duration_ms;
-    bs->active = true;
-  }
+  ledFxBlink(ledFxChannel(pin), blink_ms, duration_ms);
 }
 
 /**
- * Set RGB color using PWM
+ * Set RGB color using PWM (immediately)
  */
 void setRGBColor(int r, int g, int b) {
+  fadeRGBColor(r, g, b, 0);
+}
+
+/**
+ * Cross-fade from the colour currently shown to a new one
+ */
+void fadeRGBColor(int r, int g, int b, uint16_t fade_ms) {
   // Constrain values to 0-255
   rgbR = constrain(r, 0, 255);
   rgbG = constrain(g, 0, 255);
   rgbB = constrain(b, 0, 255);
-  
-  // ESP8266 PWM range is 0-1023
-  analogWrite(RGB_RED_PIN,   map(rgbR, 0, 255, 0, 1023));
-  analogWrite(RGB_GREEN_PIN, map(rgbG, 0, 255, 0, 1023));
-  analogWrite(RGB_BLUE_PIN,  map(rgbB, 0, 255, 0, 1023));
+
+  fadeTimer.detach();
+  const int target[3] = {rgbR, rgbG, rgbB};
+  for (uint8_t i = 0; i < 3; i++) {
+    fadeFrom[i] = levelNow[i];   // Start from mid-fade position if any
+    fadeTo[i] = gammaLevel8(target[i]);
+  }
+
+  fadeStart = millis();
+  fadeMs = fade_ms;
+  if (fade_ms == 0) {
+    fadeStep();
+    return;
+  }
+  fadeTimer.attach_ms(RGB_FADE_STEP_MS, fadeStep);
 }
 
 /**
@@ -124,27 +129,15 @@ void getRGBColor(int& r, int& g, int& b) {
 }
 
 /**
- * Set digital LED state
+ * Set digital LED state (applied after a running blink finishes)
  */
 void setLED(uint8_t pin, bool state) {
-  if (pin == PIN_LED1) {
-    led1State = state;
-    if (!blink1.active) {  // Only apply if not blinking
-      digitalWrite(PIN_LED1, state ? HIGH : LOW);
-    }
-  } else if (pin == PIN_LED2) {
-    led2State = state;
-    if (!blink2.active) {  // Only apply if not blinking
-      digitalWrite(PIN_LED2, state ? HIGH : LOW);
-    }
-  }
+  ledFxHold(ledFxChannel(pin), state);
 }
 
 /**
  * Get digital LED state
  */
 bool getLED(uint8_t pin) {
-  if (pin == PIN_LED1) return led1State;
-  if (pin == PIN_LED2) return led2State;
-  return false;
+  return ledFxLevel(ledFxChannel(pin));
 }
@@ -2,7 +2,8 @@
 // leds.h - LED and RGB Control Interface
 // ============================================================================
 // Purpose: Control digital LEDs (Part 2A) and RGB LED (Part 2B)
-// Features: Non-blocking blink, PWM RGB control, status polling
+// Features: Timer-driven blink (ledfx.h), gamma-corrected PWM RGB control
+//           with timed cross-fades (gamma.h), status polling
 // ============================================================================
 
 #pragma once
@@ -13,15 +14,9 @@
  */
 void ledsBegin();
 
-/**
- * Poll LED states for non-blocking blink timing
- * Call every loop iteration
- */
-void ledsPoll();
-
 /**
  * Start a non-blocking blink sequence on specified LED
- * @param pin LED pin number (PIN_LED1 or PIN_LED2)
+ * @param pin LED pin number (any pin attached in ledsBegin())
  * @param duration_ms Total duration of blink (milliseconds)
  * @param blink_ms On/off period for blinking (milliseconds)
  */
@@ -36,7 +31,19 @@ void blinkAsync(uint8_t pin, uint16_t blink_ms, uint16_t duration_ms);
 void setRGBColor(int r, int g, int b);
 
 /**
- * Get current RGB LED values
+ * Fade the RGB LED to a new colour. Stepping runs on a Ticker, i.e.
+ * whenever loop() yields; a blocking stretch (TLS handshake) holds the
+ * colour, then the fade jumps to where it should be by then. (Not on the
+ * timer interrupt like the digital LEDs - see leds.cpp.)
+ * @param r Red value (0-255)
+ * @param g Green value (0-255)
+ * @param b Blue value (0-255)
+ * @param fade_ms Fade duration (0 = immediate)
+ */
+void fadeRGBColor(int r, int g, int b, uint16_t fade_ms);
+
+/**
+ * Get current RGB LED values (target of a running fade)
  */
 void getRGBColor(int& r, int& g, int& b);
 
@@ -0,0 +1,243 @@
+// ============================================================================
+// logger.cpp - Ring-Buffered Logger Implementation
+// ============================================================================
+// The ring holds finished text; head is written only by the log calls and
+// tail only by the drain, both from CONT. One byte is kept free to tell
+// "full" from "empty". The drain task is a one-shot armed only while text
+// is waiting, so an idle logger never keeps the scheduler awake.
+// ============================================================================
+
+#include "logger.h"
+#include "task_sched.h"
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of two");
+
+static char ring[LOG_RING_SIZE];
+static uint16_t head = 0;
+static uint16_t tail = 0;
+static uint32_t pendingDrops = 0;      // Not yet reported in the stream
+static LogStats stats = {0, 0, 0, 0, 0, 0, 0};
+static SchedTask drainTask;
+static bool started = false;           // logBegin() called - drain in the background
+static bool drainArmed = false;
+
+static inline uint16_t used() {
+  return (head - tail) & (LOG_RING_SIZE - 1);
+}
+
+static inline uint16_t room() {
+  return LOG_RING_SIZE - 1 - used();
+}
+
+static void push(const char* s, uint16_t len) {
+  uint16_t first = LOG_RING_SIZE - head;
+  if (first > len) first = len;
+  memcpy(ring + head, s, first);
+  memcpy(ring, s + first, len - first);
+  head = (head + len) & (LOG_RING_SIZE - 1);
+
+  stats.bytes += len;
+  if (used() > stats.highWater) stats.highWater = used();
+}
+
+/**
+ * Hand the UART up to limit bytes from the ring (contiguous chunks)
+ */
+static void drainUpTo(size_t limit) {
+  while (limit && tail != head) {
+    uint16_t chunk = (head > tail) ? head - tail : LOG_RING_SIZE - tail;
+    if (chunk > limit) chunk = limit;
+    Serial.write((const uint8_t*)ring + tail, chunk);
+    tail = (tail + chunk) & (LOG_RING_SIZE - 1);
+    limit -= chunk;
+  }
+}
+
+static void drainFn();
+
+/**
+ * Come back for the rest once the FIFO has emptied a bit
+ */
+static void armDrain() {
+  if (!started || drainArmed || tail == head) return;
+  drainArmed = true;
+  schedAfter(drainTask, "log", drainFn, LOG_DRAIN_MS);
+}
+
+static void drainFn() {
+  drainArmed = false;
+  logDrain();
+}
+
+void logBegin() {
+  started = true;
+  armDrain();
+}
+
+void logDrain() {
+  if (!started) {
+    drainUpTo(LOG_RING_SIZE);           // Nothing would come back - write through
+    return;
+  }
+  int fifo = Serial.availableForWrite();
+  if (fifo > 0) drainUpTo(fifo);
+  armDrain();
+}
+
+void logFlush() {
+  drainUpTo(LOG_RING_SIZE);
+  Serial.flush();
+}
+
+/**
+ * "[LOG] N dropped" once it fits, so gaps in the output are visible
+ */
+static void reportDrops() {
+  char note[40];
+  int n = snprintf_P(note, sizeof(note), PSTR("[LOG] %lu lines dropped\n"),
+                     (unsigned long)pendingDrops);
+  if (n > 0 && n < (int)sizeof(note) && n <= room()) {
+    push(note, n);
+    pendingDrops = 0;
+  }
+}
+
+/**
+ * Queue one finished line or record whole, or count it as dropped
+ */
+static void queueLine(uint8_t level, const char* data, size_t n) {
+  if (pendingDrops) reportDrops();
+  if (pendingDrops || n > room()) {
+    stats.dropped++;
+    pendingDrops++;
+  } else {
+    push(data, n);
+    stats.lines++;
+    if (level == LOG_ERROR) stats.errors++;
+    if (level == LOG_WARN) stats.warnings++;
+  }
+  logDrain();
+}
+
+void logWrite(uint8_t level, PGM_P tag, PGM_P fmt, ...) {
+  char line[LOG_LINE_MAX];
+  size_t n = 0;
+  line[n++] = '[';
+  size_t tagLen = strlen_P(tag);
+  if (tagLen > 16) tagLen = 16;
+  memcpy_P(line + n, tag, tagLen);
+  n += tagLen;
+  line[n++] = ']';
+  line[n++] = ' ';
+
+  va_list ap;
+  va_start(ap, fmt);
+  int len = vsnprintf_P(line + n, sizeof(line) - n - 1, fmt, ap);   // -1: newline
+  va_end(ap);
+  if (len > 0) {
+    size_t avail = sizeof(line) - n - 2;
+    if ((size_t)len > avail) {
+      len = avail;
+      stats.truncated++;
+    }
+    n += len;
+  }
+  line[n++] = '\n';
+  queueLine(level, line, n);
+}
+
+void logConsole(PGM_P fmt, ...) {
+  char line[LOG_LINE_MAX];
+  va_list ap;
+  va_start(ap, fmt);
+  int len = vsnprintf_P(line, sizeof(line), fmt, ap);
+  va_end(ap);
+  if (len <= 0) return;
+  if ((size_t)len >= sizeof(line)) {
+    len = sizeof(line) - 1;
+    stats.truncated++;
+  }
+
+  // Requested output: wait for the UART rather than lose it
+  if ((size_t)len > room()) drainUpTo(len - room());
+  push(line, len);
+  logDrain();
+}
+
+const LogStats& logStats() {
+  return stats;
+}
+
+void logPrintStats() {
+  CONSOLE("\n[LOG] %lu lines (%lu errors, %lu warnings), %lu bytes\n",
+          (unsigned long)stats.lines, (unsigned long)stats.errors,
+          (unsigned long)stats.warnings, (unsigned long)stats.bytes);
+  CONSOLE("  Dropped: %lu, truncated: %lu, ring peak %u / %u B\n",
+          (unsigned long)stats.dropped, (unsigned long)stats.truncated,
+          stats.highWater, LOG_RING_SIZE - 1);
+}
+
+#ifdef LOG_TOKENIZED
+// ==== Tokenized records ====
+
+static const uint8_t RECORD_HEADER = 7;    // Mark, length, token, level
+static_assert(LOG_LINE_MAX <= 257, "Record length must fit in one byte");
+
+LogEncoder::LogEncoder(uint8_t level, uint32_t token)
+    : level_(level), len_(RECORD_HEADER), truncated_(false) {
+  buf_[0] = LOG_RECORD_MARK;
+  memcpy(buf_ + 2, &token, 4);             // Xtensa is little-endian
+  buf_[6] = level;
+}
+
+bool LogEncoder::room(size_t n) {
+  if (!truncated_ && len_ + n + 1 <= sizeof(buf_)) return true;   // +1: CRC
+  truncated_ = true;
+  return false;
+}
+
+void LogEncoder::putVarint(uint64_t v) {
+  do {
+    uint8_t b = v & 0x7F;
+    v >>= 7;
+    buf_[len_++] = v ? (b | 0x80) : b;
+  } while (v);
+}
+
+void LogEncoder::putInt(int64_t v) {
+  if (!room(10)) return;
+  putVarint(((uint64_t)v << 1) ^ (uint64_t)(v >> 63));   // Zigzag: small negatives stay short
+}
+
+void LogEncoder::putFloat(float v) {
+  if (!room(4)) return;
+  memcpy(buf_ + len_, &v, 4);
+  len_ += 4;
+}
+
+void LogEncoder::putString(const char* s) {
+  if (!s) s = "(null)";
+  if (!room(2)) return;
+  size_t n = strlen(s);
+  size_t fit = sizeof(buf_) - 1 - len_ - (n < 128 ? 1 : 2);
+  if (n > fit) {
+    n = fit;
+    truncated_ = true;
+  }
+  putVarint(n);
+  memcpy(buf_ + len_, s, n);
+  len_ += n;
+}
+
+void LogEncoder::commit() {
+  uint8_t crc = 0;
+  for (uint8_t i = 2; i < len_; i++) {
+    crc ^= buf_[i];
+    for (uint8_t b = 0; b < 8; b++) crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+  }
+  buf_[1] = len_ - 2;
+  buf_[len_++] = crc;
+  if (truncated_) stats.truncated++;
+  queueLine(level_, (const char*)buf_, len_);
+}
+#endif
@@ -0,0 +1,190 @@
+// ============================================================================
+// logger.h - Asynchronous Ring-Buffered Logger
+// ============================================================================
+// Purpose: Keep UART time off the hot path. At 9600 baud every character
+//          costs ~1 ms, and Serial.print() blocks once the 128-byte UART
+//          FIFO is full.
+// Method: Each call formats one complete line (format string in flash)
+//         into LOG_RING_SIZE bytes of RAM and returns. logDrain() - run by
+//         the scheduler and after every log call - only hands the UART as
+//         many bytes as its FIFO has room for, so it never waits. Until
+//         logBegin() the logger writes through (blocking) like Serial.print.
+// Full ring: The whole line is dropped and counted; a "[LOG] N dropped"
+//            line is inserted once there is room again
+// Levels: LOGE/LOGW/LOGI/LOGD(tag, fmt, ...). Anything above LOG_LEVEL
+//         (config.h, or -D LOG_LEVEL=n) compiles to nothing - no code, no
+//         string; its arguments are only type-checked against the format,
+//         never evaluated. A module may set its own ceiling by defining
+//         LOG_LOCAL_LEVEL before including this header.
+// Console: CONSOLE(fmt, ...) is for output the user asked for (serial menu
+//          reports, boot banner). It shares the ring so lines stay in
+//          order, is never filtered or dropped, and waits for room instead.
+// Tokenized: With -D LOG_TOKENIZED the LOGx calls send a binary record
+//            instead: a 32-bit token (FNV-1a of tag and format, computed
+//            at compile time) plus the raw arguments. No formatting on the
+//            device and no format strings in flash; tools/log_decode.py
+//            rebuilds the lines from the sources. CONSOLE stays text.
+// Context: CONT only - do not log from ISRs
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include <type_traits>
+#include "config.h"
+
+#define LOG_NONE     0
+#define LOG_ERROR    1
+#define LOG_WARN     2
+#define LOG_INFO     3
+#define LOG_DEBUG    4
+
+#ifndef LOG_LOCAL_LEVEL
+#define LOG_LOCAL_LEVEL LOG_LEVEL
+#endif
+
+/**
+ * True if level is compiled in for this module (guard costly arguments)
+ */
+#define LOG_ENABLED(level) (LOG_LOCAL_LEVEL >= (level))
+
+/**
+ * Never called - lets the compiler check arguments against the format
+ * (the decoder relies on them matching)
+ */
+void logFormatCheck(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+#define LOG_CHECK(fmt, ...) ((void)sizeof(logFormatCheck(fmt, ##__VA_ARGS__), 0))
+
+#ifdef LOG_TOKENIZED
+#define LOG_AT(level, tag, fmt, ...)                                                     \
+  (LOG_CHECK(fmt, ##__VA_ARGS__),                                                         \
+   logTokenized((level), std::integral_constant<uint32_t, logToken(tag "\x1f" fmt)>::value, \
+                ##__VA_ARGS__))
+#else
+#define LOG_AT(level, tag, fmt, ...) \
+  (LOG_CHECK(fmt, ##__VA_ARGS__), logWrite((level), PSTR(tag), PSTR(fmt), ##__VA_ARGS__))
+#endif
+
+#if LOG_LOCAL_LEVEL >= LOG_ERROR
+#define LOGE(tag, fmt, ...) LOG_AT(LOG_ERROR, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOGE(tag, fmt, ...) LOG_CHECK(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_LOCAL_LEVEL >= LOG_WARN
+#define LOGW(tag, fmt, ...) LOG_AT(LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOGW(tag, fmt, ...) LOG_CHECK(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_LOCAL_LEVEL >= LOG_INFO
+#define LOGI(tag, fmt, ...) LOG_AT(LOG_INFO, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOGI(tag, fmt, ...) LOG_CHECK(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_LOCAL_LEVEL >= LOG_DEBUG
+#define LOGD(tag, fmt, ...) LOG_AT(LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOGD(tag, fmt, ...) LOG_CHECK(fmt, ##__VA_ARGS__)
+#endif
+
+#define CONSOLE(fmt, ...) (LOG_CHECK(fmt, ##__VA_ARGS__), logConsole(PSTR(fmt), ##__VA_ARGS__))
+
+/**
+ * Logger counters
+ */
+struct LogStats {
+  uint32_t lines;          // Log lines queued
+  uint32_t errors;         // ... of which LOG_ERROR
+  uint32_t warnings;       // ... of which LOG_WARN
+  uint32_t bytes;          // Bytes queued (log and console)
+  uint32_t dropped;        // Lines lost to a full ring
+  uint32_t truncated;      // Lines cut at LOG_LINE_MAX
+  uint16_t highWater;      // Most bytes waiting at once
+};
+
+/**
+ * Start draining from the scheduler (call once the scheduler is set up)
+ */
+void logBegin();
+
+/**
+ * Format "[tag] message\n" into the ring (use the LOGx macros)
+ */
+void logWrite(uint8_t level, PGM_P tag, PGM_P fmt, ...);
+
+/**
+ * Format into the ring, waiting for room if needed (use CONSOLE())
+ */
+void logConsole(PGM_P fmt, ...);
+
+/**
+ * Move what the UART FIFO can take right now; never blocks
+ */
+void logDrain();
+
+/**
+ * Write out everything queued (before restart or deep sleep)
+ */
+void logFlush();
+
+const LogStats& logStats();
+
+void logPrintStats();
+
+// ==== Tokenized records ====
+// 0xFF, length, token (4 bytes LE), level, arguments, CRC-8 (poly 0x07)
+// over token..arguments. 0xFF never occurs in UTF-8 text, so the decoder
+// can find records between CONSOLE lines. Arguments in call order:
+//   integers  zigzag varint of the value widened to 64 bits
+//   floats    4-byte IEEE float (doubles are narrowed)
+//   strings   varint length, then the bytes (cut to fit the record)
+
+#define LOG_RECORD_MARK 0xFF
+
+/**
+ * FNV-1a over tag, 0x1F, format - must match tools/log_decode.py
+ */
+constexpr uint32_t logToken(const char* s) {
+  uint32_t h = 2166136261UL;
+  while (*s) h = (h ^ (uint8_t)*s++) * 16777619UL;
+  return h;
+}
+
+/**
+ * Builds one record on the stack; values that no longer fit are dropped
+ * and the record is counted as truncated
+ */
+class LogEncoder {
+ public:
+  LogEncoder(uint8_t level, uint32_t token);
+  void putInt(int64_t v);
+  void putFloat(float v);
+  void putString(const char* s);
+  void commit();
+
+ private:
+  void putVarint(uint64_t v);
+  bool room(size_t n);
+
+  uint8_t level_;
+  uint8_t len_;
+  bool truncated_;
+  uint8_t buf_[LOG_LINE_MAX];
+};
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+logEncode(LogEncoder& e, T v) {
+  e.putInt((int64_t)v);
+}
+
+inline void logEncode(LogEncoder& e, double v) { e.putFloat((float)v); }
+inline void logEncode(LogEncoder& e, const char* s) { e.putString(s); }
+
+template <typename... Args>
+void logTokenized(uint8_t level, uint32_t token, Args... args) {
+  LogEncoder e(level, token);
+  (logEncode(e, args), ...);
+  e.commit();
+}
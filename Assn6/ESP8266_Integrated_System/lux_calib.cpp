@@ -0,0 +1,57 @@
+// ============================================================================
+// lux_calib.cpp - Multi-Point Lux Calibration Table Implementation
+// ============================================================================
+
+#include "lux_calib.h"
+
+// Reference points must be strictly increasing in ADC code and inside range
+constexpr bool luxCalPointsSorted() {
+  for (uint8_t i = 1; i < LUX_CAL_COUNT; i++) {
+    if (LUX_CAL_POINTS[i].adc <= LUX_CAL_POINTS[i - 1].adc) return false;
+  }
+  return LUX_CAL_POINTS[LUX_CAL_COUNT - 1].adc < LUX_LUT_SIZE;
+}
+static_assert(LUX_CAL_COUNT >= 2, "Need at least two calibration points");
+static_assert(luxCalPointsSorted(), "Calibration points must be sorted by ADC code");
+
+static constexpr LuxLut LUX_LUT PROGMEM = luxCalMakeTable();
+
+// Table check at build time: every reference point is hit exactly ...
+constexpr bool luxLutMatchesPoints() {
+  for (uint8_t i = 0; i < LUX_CAL_COUNT; i++) {
+    if (LUX_LUT.lux[LUX_CAL_POINTS[i].adc] != LUX_CAL_POINTS[i].lux) return false;
+  }
+  return true;
+}
+static_assert(luxLutMatchesPoints(), "Generated table misses a calibration point");
+
+// ... and each segment stays between its endpoints (no overshoot)
+constexpr bool luxLutBounded() {
+  for (uint8_t i = 1; i < LUX_CAL_COUNT; i++) {
+    const LuxCalPoint& a = LUX_CAL_POINTS[i - 1];
+    const LuxCalPoint& b = LUX_CAL_POINTS[i];
+    uint16_t lo = a.lux < b.lux ? a.lux : b.lux;
+    uint16_t hi = a.lux < b.lux ? b.lux : a.lux;
+    for (uint16_t adc = a.adc; adc <= b.adc; adc++) {
+      if (LUX_LUT.lux[adc] < lo || LUX_LUT.lux[adc] > hi) return false;
+    }
+  }
+  return true;
+}
+static_assert(luxLutBounded(), "Generated table overshoots a segment");
+
+uint16_t luxFromAdc(uint16_t adc) {
+  if (adc >= LUX_LUT_SIZE) adc = LUX_LUT_SIZE - 1;
+  return pgm_read_word(&LUX_LUT.lux[adc]);
+}
+
+uint16_t luxFromAdcQ(int32_t adcQ, uint8_t frac) {
+  if (adcQ <= 0) return luxFromAdc(0);
+  uint32_t code = (uint32_t)adcQ >> frac;
+  if (code >= LUX_LUT_SIZE - 1) return luxFromAdc(LUX_LUT_SIZE - 1);
+
+  int32_t a = pgm_read_word(&LUX_LUT.lux[code]);
+  int32_t b = pgm_read_word(&LUX_LUT.lux[code + 1]);
+  int32_t f = adcQ & ((1L << frac) - 1);
+  return (uint16_t)(a + (((b - a) * f) >> frac));
+}
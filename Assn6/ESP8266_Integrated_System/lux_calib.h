@@ -0,0 +1,90 @@
+// ============================================================================
+// lux_calib.h - Multi-Point Lux Calibration Table
+// ============================================================================
+// Purpose: Convert HW-486 ADC codes to lux with a piecewise-linear fit
+//          through measured reference points
+// Method: The reference points below are expanded at compile time into a
+//         1024-entry table in flash (PROGMEM), indexed by the raw 10-bit
+//         ADC code. A conversion is one table read plus an interpolation
+//         between neighbouring codes for oversampled (fixed-point) input.
+// Recalibrating: Replace LUX_CAL_POINTS with new (ADC, lux) pairs measured
+//                against the reference meter, set LUX_CAL_MEASURED in
+//                config.h and rebuild. The static_asserts in lux_calib.cpp
+//                check the generated table at build time, and
+//                test/test_host/test_lux_calib.cpp checks conversions against
+//                the points (pio test -e native).
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+/**
+ * One calibration measurement: raw ADC code and reference meter reading
+ */
+struct LuxCalPoint {
+  uint16_t adc;
+  uint16_t lux;
+};
+
+/**
+ * Reference points, sorted by ADC code (sensor is inverted: lux falls as
+ * the code rises). Placeholder values taken from the Assn3 linear fit
+ * (Lux = 1678.25 - 2500 * V, R² = 0.735) until the multi-point
+ * measurement is redone - replace with the meter readings.
+ */
+static constexpr LuxCalPoint LUX_CAL_POINTS[] = {
+  {   0, 1678 },
+  { 200, 1189 },
+  { 400,  701 },
+  { 600,  212 },
+  { 687,    0 },
+  {1023,    0 }
+};
+static constexpr uint8_t LUX_CAL_COUNT = sizeof(LUX_CAL_POINTS) / sizeof(LUX_CAL_POINTS[0]);
+
+static constexpr uint16_t LUX_LUT_SIZE = 1024;   // One entry per ADC code
+
+/**
+ * Generated table type (wrapped in a struct so it can be built constexpr)
+ */
+struct LuxLut {
+  uint16_t lux[LUX_LUT_SIZE];
+};
+
+/**
+ * Piecewise-linear interpolation through the reference points, rounded.
+ * Codes outside the first/last point hold the end value.
+ */
+constexpr uint16_t luxCalInterpolate(uint16_t adc) {
+  if (adc <= LUX_CAL_POINTS[0].adc) return LUX_CAL_POINTS[0].lux;
+  for (uint8_t i = 1; i < LUX_CAL_COUNT; i++) {
+    const LuxCalPoint& a = LUX_CAL_POINTS[i - 1];
+    const LuxCalPoint& b = LUX_CAL_POINTS[i];
+    if (adc <= b.adc) {
+      int32_t span = b.adc - a.adc;
+      int32_t num = ((int32_t)b.lux - a.lux) * (adc - a.adc);
+      int32_t step = (num >= 0) ? (num + span / 2) / span : -((-num + span / 2) / span);
+      return (uint16_t)(a.lux + step);
+    }
+  }
+  return LUX_CAL_POINTS[LUX_CAL_COUNT - 1].lux;
+}
+
+constexpr LuxLut luxCalMakeTable() {
+  LuxLut t = {};
+  for (uint16_t adc = 0; adc < LUX_LUT_SIZE; adc++) {
+    t.lux[adc] = luxCalInterpolate(adc);
+  }
+  return t;
+}
+
+/**
+ * Convert a raw 10-bit ADC code to lux (one flash read)
+ */
+uint16_t luxFromAdc(uint16_t adc);
+
+/**
+ * Convert a fixed-point ADC value with FRAC fraction bits (e.g. the output
+ * of Oversampler/MovingAverage) to lux, interpolating between codes
+ */
+uint16_t luxFromAdcQ(int32_t adcQ, uint8_t frac);
@@ -15,9 +15,10 @@
  * 
  * Hardware:
  *   Inputs:
- *     - Switch 1 (GPIO0):  Triggers sensor logging to Google Sheets + IFTTT Webhook Notification
+ *     - Switch 1 (GPIO0):  Triggers sensor logging to Google Sheets + batched notification
  *     - Switch 2 (GPIO16): Triggers LED/RGB status check + notifications
  *     - DHT11 (GPIO14):    Temperature and humidity sensor
+ *     - HW-486 (A0):       Light sensor (calibrated lux)
  *   
  *   Outputs:
  *     - LED1 (GPIO12):     Visual feedback + remote control
@@ -26,10 +27,10 @@
  * 
  * Operation:
  *   Switch 1 Press:
- *     1. Read DHT11 sensor (temperature, humidity)
+ *     1. Read cached sensor reading (background sampler, all registered sensors)
  *     2. Get NTP timestamp
  *     3. Send data to Google Sheets via PHP endpoint
- *     4. Send notification to Slack/SMS
+ *     4. Queue notification (batched Slack/SMS)
  *     5. Blink LED1 for visual confirmation
  *   
  *   Switch 2 Press:
@@ -41,15 +42,19 @@
  * 
  * Features:
  *   - Non-blocking event-driven architecture
+ *   - Timer-wheel task scheduler (sleeps until the next deadline)
+ *   - Button pipelines as stackless coroutines (run interleaved)
+ *   - Windowed min/max/mean/stddev uploads (one POST per window)
+ *   - EWMA z-score anomaly detection -> immediate IFTTT alert
  *   - Message buffering and retry logic
  *   - Simultaneous switch handling (both switches can be pressed rapidly)
- *   - Battery operation capable (can run independently)
+ *   - Battery operation: light sleep or deep-sleep duty cycle, RTC state
  *   - Visual LED feedback for all operations
  *   - Robust error handling and recovery
  * 
  * Dependencies:
  *   - ESP8266 Arduino Core (WiFi, HTTPClient)
- *   - Adafruit DHT sensor library
+ *   - Interrupt-driven DHT driver (dht_async)
  *   - ArduinoJson
  *   - NTP time synchronization
  *
@@ -80,17 +85,37 @@
 #include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
 #include "config.h"
+#include "logger.h"
 #include "switches.h"
 #include "sensors.h"
+#include "sampler.h"
+#include "aggregate.h"
+#include "report.h"
+#include "anomaly.h"
+#include "messaging.h"
+#include "gpio_hal.h"
+#include "events.h"
+#include "task_sched.h"
+#include "pt.h"
+#include "power.h"
+#include "profile.h"
+#include "heap_trace.h"
+#include "static_string.h"
+#include "mem_pool.h"
 #include "time_client.h"
 #include "leds.h"
 #include "control.h"
 #include "net.h"
+#include "tx.h"
+#include "kvstore.h"
+
+static_assert(gpioPinsDistinct<PIN_SWITCH_1, PIN_SWITCH_2, PIN_DHT, PIN_LED1, PIN_LED2,
+                               RGB_RED_PIN, RGB_GREEN_PIN, RGB_BLUE_PIN>(),
+              "Pin assignment in config.h uses a flash pin or shares a GPIO");
 
 // ============================================================================
 // CONFIGURATION
 // ============================================================================
-const char* SENSOR_DASHBOARD_URL = "https://huynguyen.co/Chartjs/sensor_dashboard.php";
 const char* IFTTT_WEBHOOK_KEY = "WEBHOOK_KEY";  // Replace with actual PSK
 const char* IFTTT_EVENT_NAME = "sensor_alert";
 
@@ -104,124 +129,61 @@ static bool autoRestartEnabled = true;
 bool checkMemoryAndRestart() {
   int freeHeap = ESP.getFreeHeap();
   
-  Serial.print("\n[MEM] Current free heap: ");
-  Serial.print(freeHeap);
-  Serial.println(" bytes");
+  LOGI("MEM", "Current free heap: %d bytes", freeHeap);
   
   if (freeHeap < MIN_MEMORY_FOR_SSL) {
-    Serial.println("\n╔════════════════════════════════════════════════╗");
-    Serial.println("║  ⚠ LOW MEMORY DETECTED!                        ║");
-    Serial.println("╠════════════════════════════════════════════════╣");
-    Serial.print("║  Free: ");
-    Serial.print(freeHeap);
-    Serial.println(" bytes (need 20,000+)          ║");
-    Serial.println("║                                                ║");
+    LOGE("MEM", "LOW MEMORY: %d bytes free (need %d+)", freeHeap, MIN_MEMORY_FOR_SSL);
     
     if (autoRestartEnabled) {
-      Serial.println("║  → AUTO-RESTARTING in 3 seconds...            ║");
-      Serial.println("║     (This will free memory for SSL)           ║");
-      Serial.println("║     LEDs/RGB/Sensors will be preserved        ║");
-      Serial.println("╚════════════════════════════════════════════════╝\n");
+      LOGW("RESTART", "Auto-restarting in 3 seconds to free memory for SSL");
+      LOGW("RESTART", "LEDs/RGB/Sensors will be preserved");
       
       delay(1000);
-      Serial.println("[RESTART] 3...");
+      LOGW("RESTART", "3...");
       delay(1000);
-      Serial.println("[RESTART] 2...");
+      LOGW("RESTART", "2...");
       delay(1000);
-      Serial.println("[RESTART] 1...");
+      LOGW("RESTART", "1...");
       delay(500);
-      Serial.println("[RESTART] Rebooting now...\n");
+      LOGW("RESTART", "Rebooting now...");
+      logFlush();
       
       ESP.restart();
       // Never returns
     } else {
-      Serial.println("║  → Auto-restart DISABLED                      ║");
-      Serial.println("║     Button 1 will likely fail                 ║");
-      Serial.println("║     Type 'R' to restart manually              ║");
-      Serial.println("╚════════════════════════════════════════════════╝\n");
+      LOGW("MEM", "Auto-restart DISABLED - Button 1 will likely fail, type 'R' to restart");
       return false;
     }
   }
   
-  Serial.println("[MEM] ✓ Memory sufficient for SSL operations");
+  LOGI("MEM", "Memory sufficient for SSL operations");
   return true;
 }
 
-// ============================================================================
-// Transmit to Database
-// ============================================================================
-bool transmitToDatabase(const String& timestamp, float temp, float humidity, uint32_t count) {
-  Serial.println("\n╔════════════════════════════════════════════════╗");
-  Serial.println("║        TRANSMITTING TO DATABASE                ║");
-  Serial.println("╚════════════════════════════════════════════════╝");
-  
-  if (!ensureWiFi()) return false;
-  
-  StaticJsonDocument<512> doc;
-  doc["node"] = 1;
-  doc["temperature_C"] = temp;
-  doc["humidity_pct"] = humidity;
-  doc["timestamp"] = timestamp;
-  doc["activity_count"] = count;
-  
-  String jsonPayload;
-  serializeJson(doc, jsonPayload);
-  
-  Serial.print("[TX] Payload: ");
-  Serial.println(jsonPayload);
-
-  WiFiClientSecure* client = new WiFiClientSecure();
-  client->setInsecure();
-  client->setTimeout(15000);
-
-  HTTPClient https;
-  https.setTimeout(15000);
-  https.setReuse(false);
-  
-  if (!https.begin(*client, SENSOR_DASHBOARD_URL)) {
-    delete client;
-    return false;
-  }
-  
-  https.addHeader("Content-Type", "application/json");
-  
-  int httpCode = https.POST(jsonPayload);
-  
-  Serial.print("[TX] HTTP Code: ");
-  Serial.println(httpCode);
-  
-  if (httpCode > 0) {
-    Serial.println(https.getString());
-  }
-
-  https.end();
-  delete client;
-  
-  return (httpCode == 200);
-}
-
 // ============================================================================
 // IFTTT Notification
 // ============================================================================
-bool sendIFTTTNotification(const String& nodeName, float temp, float humidity) {
+bool sendIFTTTNotification(const char* value1, const char* value2, const char* value3) {
+  HEAP_SCOPE(HT_IFTTT);
   if (!ensureWiFi()) return false;
 
-  Serial.println("\n[IFTTT] Sending webhook...");
+  LOGI("IFTTT", "Sending webhook...");
   
-  String url = "https://maker.ifttt.com/trigger/";
+  StaticString<URL_MAX> url = "https://maker.ifttt.com/trigger/";
   url += IFTTT_EVENT_NAME;
   url += "/with/key/";
   url += IFTTT_WEBHOOK_KEY;
 
-  StaticJsonDocument<256> doc;
-  doc["value1"] = nodeName;
-  doc["value2"] = String(temp, 1);
-  doc["value3"] = String(humidity, 1);
+  JsonDocument doc(&jsonPool);
+  doc["value1"] = value1;
+  doc["value2"] = value2;
+  doc["value3"] = value3;
   
-  String payload;
+  StaticString<256> payload;
   serializeJson(doc, payload);
 
-  WiFiClientSecure* client = new WiFiClientSecure();
+  std::unique_ptr<WiFiClientSecure, PoolDeleter> client(poolNew<WiFiClientSecure>());
+  if (!client) return false;
   client->setInsecure();
   client->setTimeout(10000);
 
@@ -229,67 +191,412 @@ bool sendIFTTTNotification(const String& nodeName, float temp, float humidity) {
   https.setTimeout(10000);
   https.setReuse(false);
   
-  if (!https.begin(*client, url)) {
-    delete client;
-    return false;
-  }
+  if (!https.begin(*client, url.c_str())) return false;
 
   https.addHeader("Content-Type", "application/json");
-  int code = https.POST(payload);
+  int code = https.POST((const uint8_t*)payload.c_str(), payload.length());
   
-  Serial.print("[IFTTT] Code: ");
-  Serial.println(code);
+  LOGI("IFTTT", "Code: %d", code);
   
   if (code > 0) {
-    Serial.println(https.getString());
+    PoolString reply(HTTP_REPLY_MAX);
+    StringSink sink(reply);
+    https.writeToStream(&sink);
+    LOGD("IFTTT", "Reply: %s", reply.c_str());
   }
 
   https.end();
-  delete client;
-  
   return (code == 200);
 }
 
 // ============================================================================
 // Menu & Auto-Poll
 // ============================================================================
+static void setAutoPollInterval(uint32_t ms);
+static void applyPowerPeriods();
+
 static void serialMenu() {
   if (!Serial.available()) return;
   char c = Serial.read();
   
   if (c == 'M' || c == 'm') {
-    Serial.println("\n╔════════════════════════╗");
-    Serial.println("║  MEMORY STATUS         ║");
-    Serial.println("╚════════════════════════╝");
-    Serial.print("Free: ");
-    Serial.print(ESP.getFreeHeap());
-    Serial.println(" bytes");
-    Serial.print("Frag: ");
-    Serial.print(ESP.getHeapFragmentation());
-    Serial.println("%");
-    Serial.print("Need: ");
-    Serial.print(MIN_MEMORY_FOR_SSL);
-    Serial.println(" bytes for SSL");
+    CONSOLE("\n╔════════════════════════╗\n");
+    CONSOLE("║  MEMORY STATUS         ║\n");
+    CONSOLE("╚════════════════════════╝\n");
+    CONSOLE("Free: %lu bytes\n", (unsigned long)ESP.getFreeHeap());
+    CONSOLE("Frag: %u%%\n", ESP.getHeapFragmentation());
+    CONSOLE("Need: %d bytes for SSL\n", MIN_MEMORY_FOR_SSL);
   } else if (c == 'R' || c == 'r') {
-    Serial.println("\n[RESTART] Manual restart requested...");
-    delay(1000);
+    CONSOLE("\n[RESTART] Manual restart requested...\n");
+    logFlush();
     ESP.restart();
   } else if (c == 'A' || c == 'a') {
     autoRestartEnabled = !autoRestartEnabled;
-    Serial.print("\n[AUTO-RESTART] ");
-    Serial.println(autoRestartEnabled ? "ENABLED" : "DISABLED");
+    CONSOLE("\n[AUTO-RESTART] %s\n", autoRestartEnabled ? "ENABLED" : "DISABLED");
+  } else if (c == 'K' || c == 'k') {
+    kvPrintStats();
+  } else if (c == 'G' || c == 'g') {
+    gpioBenchmark();
+  } else if (c == 'T' || c == 't') {
+    schedPrintProfile();
+  } else if (c == 'H' || c == 'h') {
+    heapTracePrint();
+    poolPrintStats();
+  } else if (c == 'P' || c == 'p') {
+    profilePrintAndReset();
+  } else if (c == 'W' || c == 'w') {
+    powerPrintStats();
+  } else if (c == 'S' || c == 's') {
+    PowerMode next = (PowerMode)((powerMode() + 1) % POWER_MODE_COUNT);
+    if (!powerModeAvailable(next)) next = (PowerMode)((next + 1) % POWER_MODE_COUNT);
+    powerSetMode(next);
+    applyPowerPeriods();
+  } else if (c == 'I' || c == 'i') {
+    long ms = Serial.parseInt();   // Negative input would wrap to ~49 days
+    setAutoPollInterval(ms > 0 ? (uint32_t)ms : 0);
+  } else if (c == 'N' || c == 'n') {
+    long ms = Serial.parseInt();
+    if (ms > 0 && aggSetWindowMs(ms)) CONSOLE("\n[AGG] Window %ld ms (saved)\n", ms);
+    else CONSOLE("\n[AGG] Window must be at least %d ms\n", AGG_WINDOW_MIN_MS);
+  } else if (c == 'B' || c == 'b') {
+    long ms = Serial.parseInt();
+    if (ms > 0 && switchesSetDebounce(ms)) CONSOLE("\n[SWITCHES] Debounce %ld ms (saved)\n", ms);
+    else CONSOLE("\n[SWITCHES] Debounce must be %d-%d ms\n", DEBOUNCE_MIN_MS, DEBOUNCE_MAX_MS);
+  } else if (c == 'D' || c == 'd') {
+    sensorsPrintStats();
+    samplerPrintStats();
+    aggPrintStats();
+    reportPrintStats();
+    anomalyPrintStats();
+    CONSOLE("\n[SWITCHES] Events dropped: %lu\n", (unsigned long)switchEventsDropped());
+    eventsPrintStats();
+    logPrintStats();
+  }
+}
+
+static unsigned long autoPollInterval = AUTO_POLL_INTERVAL_MS;
+
+/**
+ * Upload closed aggregation windows - one POST per window instead of
+ * one per sample. Raw readings still go out on Button 1.
+ */
+static void handleAggregateUpload() {
+  WindowSummary summary;
+  if (!aggTakeSummary(summary)) return;
+
+  IsoTimestamp timestamp;
+  if (!readTimeISO(timestamp)) {
+    LOGW("AGG", "No time - window dropped");
+    return;
   }
+  LOGI("AGG", "Uploading window summary...");
+  if (transmitSummary(1, timestamp.c_str(), summary, switch1Count())) powerNoteReading();
 }
 
-static unsigned long lastAutoPoll = 0;
-static const unsigned long AUTO_POLL_INTERVAL = 10000;
+/**
+ * Immediate path for statistically significant excursions: raw reading
+ * to the database and an IFTTT alert (routine readings go to messaging)
+ */
+static void handleAnomalies() {
+  AnomalyEvent ev;
+  if (!anomalyTakeEvent(ev)) return;
+
+  const ChannelInfo& ci = channelInfo(ev.channel);
+  LOGW("ANOMALY", "%s = %.1f %s (baseline %.1f, z = %.1f)",
+       ci.name, ev.value, ci.unit, ev.mean, ev.z);
+
+  IsoTimestamp timestamp;
+  SensorReading reading;
+  if (readTimeISO(timestamp) && samplerGet(reading)) {
+    transmit(1, timestamp.c_str(), reading, switch1Count());
+  }
+  StaticString<48> what, value, detail;
+  what.appendf("node_1 %s anomaly", ci.name);
+  value.print(ev.value, 1);
+  value += " ";
+  value += ci.unit;
+  detail += "z=";
+  detail.print(ev.z, 1);
+  detail += " vs ";
+  detail.print(ev.mean, 1);
+  sendIFTTTNotification(what.c_str(), value.c_str(), detail.c_str());
+}
 
 static void handleAutoPoll() {
-  if (millis() - lastAutoPoll >= AUTO_POLL_INTERVAL) {
-    lastAutoPoll = millis();
-    Serial.println("\n[AUTO-POLL] Checking web commands...");
-    pollAllControls();
+  LOGD("AUTO-POLL", "Checking web commands...");
+  pollAllControls();
+}
+
+// ══════════════════════════════════════════════════════════════
+// BUTTON 1 with Memory Check & Auto-Restart
+// ══════════════════════════════════════════════════════════════
+// Sequential, but suspends between steps and while waiting for WiFi or a
+// fresh sample so Button 2 can run in between. All state lives in
+// Button1Flow - locals do not survive a PT_* wait.
+enum { B1_TIMESTAMP, B1_SENSORS, B1_DATABASE, B1_NOTIFY, B1_VISUAL, B1_STAGES };
+static LatencyHistogram b1Stage[B1_STAGES];
+static const char* const b1StageNames[B1_STAGES] = {
+  "b1.timestamp", "b1.sensors", "b1.database", "b1.notify", "b1.visual"
+};
+
+struct Button1Flow {
+  Pt pt;
+  EventBatch presses;
+  SensorReading reading;
+  IsoTimestamp timestamp;
+  uint32_t sampleAge;
+  bool sensorsOk;
+  bool dbSuccess;
+  bool notifySuccess;
+  bool busy;              // Between taking the press and the summary
+  StageTimer stage;       // Wall time per step, waits included
+};
+static Button1Flow flow1;
+
+static PtState button1Flow(Button1Flow& f) {
+  PT_BEGIN(&f.pt);
+  PT_WAIT_UNTIL(&f.pt, eventTake(EVT_SRC_SWITCH1, EVT_PRESS, f.presses));
+  f.busy = true;
+
+  LOGI("BUTTON 1", "Sensor logging event");
+  if (f.presses.count > 1) {
+    // Presses queued while the previous run was busy - one upload for all
+    LOGI("BUTTON 1", "%u presses batched (events #%lu..#%lu)", f.presses.count,
+         (unsigned long)f.presses.first.seq, (unsigned long)f.presses.lastSeq);
+  }
+  
+  // Check memory FIRST - restart if needed
+  if (!checkMemoryAndRestart()) {
+    LOGW("BUTTON 1", "Continuing with low memory (likely to fail)");
   }
+  
+  f.sensorsOk = true;
+  
+  LOGI("BUTTON 1", "[1/5] Timestamp");
+  f.stage.begin();
+  // WiFi reconnects in the background - wait for it without blocking
+  PT_WAIT_TIMEOUT(&f.pt, isWiFiUp(), PIPELINE_WIFI_WAIT_MS);
+  if (!readTimeISO(f.timestamp)) {
+    f.timestamp = "2025-11-04 00:00:00";
+    f.sensorsOk = false;
+  } else {
+    LOGI("BUTTON 1", "%s", f.timestamp.c_str());
+  }
+  f.stage.lap(b1Stage[B1_TIMESTAMP]);
+  PT_YIELD(&f.pt);
+  
+  LOGI("BUTTON 1", "[2/5] Sensors");
+  f.stage.begin();
+  // Cached by the background sampler; a stale cache is refreshed first
+  if (!samplerFresh(SAMPLE_STALE_MS)) {
+    LOGI("BUTTON 1", "Waiting for a fresh sample");
+    samplerRequestRefresh();
+    PT_WAIT_TIMEOUT(&f.pt, samplerFresh(SAMPLE_STALE_MS), PIPELINE_SAMPLE_WAIT_MS);
+  }
+  if (!samplerGet(f.reading, &f.sampleAge)) {
+    LOGE("BUTTON 1", "No recent valid sample");
+    f.sensorsOk = false;
+  } else {
+    for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+      if (!f.reading.has((SensorChannel)ch)) continue;
+      const ChannelInfo& ci = channelInfo((SensorChannel)ch);
+      LOGI("BUTTON 1", "%s: %.1f %s", ci.name, f.reading.value[ch], ci.unit);
+    }
+    LOGI("BUTTON 1", "Oldest %lu ms", (unsigned long)f.sampleAge);
+  }
+  f.stage.lap(b1Stage[B1_SENSORS]);
+  PT_YIELD(&f.pt);
+  
+  LOGI("BUTTON 1", "[3/5] Database");
+  f.stage.begin();
+  // One HTTPS POST - runs to completion, the flow resumes after it
+  f.dbSuccess = false;
+  if (f.sensorsOk) {
+    uint32_t cnt = switch1Count() + f.presses.count;
+    f.dbSuccess = transmit(1, f.timestamp.c_str(), f.reading, cnt);
+    if (f.dbSuccess) {
+      incSwitch1(f.presses.count);
+      powerNoteReading();
+    }
+  }
+  f.stage.lap(b1Stage[B1_DATABASE]);
+  PT_YIELD(&f.pt);
+  
+  LOGI("BUTTON 1", "[4/5] Notify");
+  f.stage.begin();
+  // Routine reading - batched, low priority (anomalies alert immediately)
+  f.notifySuccess = false;
+  if (f.sensorsOk) {
+    f.notifySuccess = sendSensorNotification(1, f.timestamp, f.reading.get(CH_TEMPERATURE),
+                                             f.reading.get(CH_HUMIDITY), switch1Count());
+  }
+  f.stage.lap(b1Stage[B1_NOTIFY]);
+  
+  LOGI("BUTTON 1", "[5/5] Visual");
+  blinkAsync(PIN_LED1, 250, 2000);
+  f.stage.lap(b1Stage[B1_VISUAL]);
+  
+  LOGI("BUTTON 1", "Summary: sensors %s, database %s, notify %s",
+       f.sensorsOk ? "OK" : "FAIL", f.dbSuccess ? "OK" : "FAIL",
+       f.notifySuccess ? "OK" : "FAIL");
+  
+  if (!f.dbSuccess || !f.notifySuccess) {
+    LOGW("BUTTON 1", "System will auto-restart before next Button 1 if memory is low");
+  }
+  f.busy = false;
+  PT_END(&f.pt);
+}
+
+// ══════════════════════════════════════════════════════════════
+// BUTTON 2
+// ══════════════════════════════════════════════════════════════
+enum { B2_LED, B2_RGB, B2_REPORT, B2_STAGES };
+static LatencyHistogram b2Stage[B2_STAGES];
+static const char* const b2StageNames[B2_STAGES] = {"b2.led", "b2.rgb", "b2.report"};
+
+struct Button2Flow {
+  Pt pt;
+  EventBatch presses;
+  bool busy;
+  StageTimer stage;
+};
+static Button2Flow flow2;
+
+static PtState button2Flow(Button2Flow& f) {
+  PT_BEGIN(&f.pt);
+  PT_WAIT_UNTIL(&f.pt, eventTake(EVT_SRC_SWITCH2, EVT_PRESS, f.presses));
+  f.busy = true;
+
+  LOGI("BUTTON 2", "Status check (%u press)...", f.presses.count);
+  f.stage.begin();
+  PT_WAIT_TIMEOUT(&f.pt, isWiFiUp(), PIPELINE_WIFI_WAIT_MS);
+  pollLEDControl();
+  f.stage.lap(b2Stage[B2_LED]);
+  PT_YIELD(&f.pt);
+  f.stage.begin();
+  pollRGBControl();
+  f.stage.lap(b2Stage[B2_RGB]);
+  PT_YIELD(&f.pt);
+  f.stage.begin();
+  LOGI("BUTTON 2", "%s", getLEDStatusString().c_str());
+  LOGI("BUTTON 2", "%s", getRGBStatusString().c_str());
+  blinkAsync(PIN_LED2, 250, 2000);
+  f.stage.lap(b2Stage[B2_REPORT]);
+  incSwitch2(f.presses.count);
+  f.busy = false;
+  PT_END(&f.pt);
+}
+
+// ══════════════════════════════════════════════════════════════
+// DEEP-SLEEP DUTY CYCLE (POWER_DEEP only)
+// ══════════════════════════════════════════════════════════════
+// Sensor-only cycle: log one fresh reading, give the buttons a short
+// window, then deep sleep until the next cycle
+struct DutyFlow {
+  Pt pt;
+  SensorReading reading;
+  IsoTimestamp timestamp;
+};
+static DutyFlow dutyFlow;
+
+static PtState runDutyCycle(DutyFlow& f) {
+  PT_BEGIN(&f.pt);
+  PT_WAIT_UNTIL(&f.pt, powerMode() == POWER_DEEP);
+  LOGI("POWER", "Duty cycle: logging one reading");
+
+  PT_WAIT_TIMEOUT(&f.pt, samplerFresh(SAMPLE_STALE_MS), PIPELINE_SAMPLE_WAIT_MS);
+  PT_WAIT_TIMEOUT(&f.pt, isWiFiUp(), PIPELINE_WIFI_WAIT_MS);
+  if (readTimeISO(f.timestamp) && samplerGet(f.reading) &&
+      transmit(1, f.timestamp.c_str(), f.reading, switch1Count())) {
+    powerNoteReading();
+  }
+
+  PT_SLEEP(&f.pt, POWER_DEEP_GRACE_MS);
+  PT_WAIT_UNTIL(&f.pt, !flow1.busy && !flow2.busy);
+  if (powerMode() == POWER_DEEP) powerDeepSleep(POWER_DEEP_SLEEP_MS);
+  PT_END(&f.pt);
+}
+
+// ============================================================================
+// Tasks - one per activity, run by the scheduler at their own rate
+// ============================================================================
+static SchedTask serialTask, inputTask, samplerTask, housekeepTask, autoPollTask, dutyTask;
+
+static void inputTaskFn() {
+  HEAP_SCOPE(HT_APP);
+  pollSwitches();
+
+  // Interleave the pipelines; come straight back if one has more to do
+  PtState s1 = button1Flow(flow1);
+  PtState s2 = button2Flow(flow2);
+  if (s1 == PT_YIELDED || s2 == PT_YIELDED) schedWake();
+}
+
+static void samplerTaskFn() {
+  HEAP_SCOPE(HT_APP);
+  samplerPoll();
+  aggPoll();
+  handleAnomalies();
+}
+
+static void housekeepTaskFn() {
+  HEAP_SCOPE(HT_APP);
+  handleAggregateUpload();
+  messagingPoll();
+  heapTraceSample();
+}
+
+static void dutyTaskFn() {
+  HEAP_SCOPE(HT_APP);
+  runDutyCycle(dutyFlow);
+}
+
+/**
+ * New web command poll interval, applied to the running task and persisted
+ */
+static void setAutoPollInterval(uint32_t ms) {
+  if (ms < AUTO_POLL_MIN_MS) {
+    CONSOLE("\n[AUTO-POLL] Interval must be at least %d ms\n", AUTO_POLL_MIN_MS);
+    return;
+  }
+  autoPollInterval = ms;
+  schedSetPeriod(autoPollTask, ms);   // Only stores it while cancelled (deep mode)
+  kvPutU32(KV_AUTO_POLL_MS, ms);
+  CONSOLE("\n[AUTO-POLL] Every %lu ms (saved)\n", (unsigned long)ms);
+}
+
+/**
+ * Task rates for the power mode: polled tasks run less often outside
+ * active mode, so the scheduler leaves longer idle gaps; web command
+ * polling stops in the deep-sleep duty cycle (up for one reading only)
+ */
+static void applyPowerPeriods() {
+  uint32_t k = (powerMode() == POWER_ACTIVE) ? 1 : SCHED_STRETCH_LOW_POWER;
+  schedSetPeriod(serialTask, SCHED_SERIAL_MS * k);
+  schedSetPeriod(inputTask, SCHED_INPUT_MS * k);     // Input events still wake it
+  schedSetPeriod(samplerTask, SCHED_SAMPLER_MS * k);
+
+  if (powerMode() == POWER_DEEP) {
+    schedCancel(autoPollTask);
+  } else {
+    schedEvery(autoPollTask, "autopoll", handleAutoPoll, autoPollInterval, autoPollInterval);
+  }
+}
+
+static void schedBegin() {
+  // Histograms print in registration order: loop, tasks, pipeline stages
+  profileBegin();
+  profileRegister(schedLoopHistogram(), "loop");
+  schedEvery(serialTask, "serial", serialMenu, SCHED_SERIAL_MS);
+  schedEvery(inputTask, "buttons", inputTaskFn, SCHED_INPUT_MS);
+  schedRunOnWake(inputTask);
+  schedEvery(samplerTask, "sampler", samplerTaskFn, SCHED_SAMPLER_MS);
+  schedEvery(housekeepTask, "housekeep", housekeepTaskFn, SCHED_HOUSEKEEP_MS);
+  schedEvery(autoPollTask, "autopoll", handleAutoPoll, autoPollInterval, autoPollInterval);
+  schedEvery(dutyTask, "duty", dutyTaskFn, SCHED_HOUSEKEEP_MS);
+  for (uint8_t i = 0; i < B1_STAGES; i++) profileRegister(b1Stage[i], b1StageNames[i]);
+  for (uint8_t i = 0; i < B2_STAGES; i++) profileRegister(b2Stage[i], b2StageNames[i]);
+  logBegin();       // Log drain task - only queued while text is waiting
 }
 
 // ============================================================================
@@ -299,39 +606,59 @@ void setup() {
   Serial.begin(9600);
   delay(1000);
   
-  Serial.println("\n\n\n");
-  Serial.println("╔════════════════════════════════════════════════╗");
-  Serial.println("║   ESP8266 AUTO-RESTART SYSTEM                  ║");
-  Serial.println("║   Restarts automatically when memory low       ║");
-  Serial.println("╚════════════════════════════════════════════════╝\n");
+  CONSOLE("\n\n\n\n");
+  CONSOLE("╔════════════════════════════════════════════════╗\n");
+  CONSOLE("║   ESP8266 AUTO-RESTART SYSTEM                  ║\n");
+  CONSOLE("║   Restarts automatically when memory low       ║\n");
+  CONSOLE("╚════════════════════════════════════════════════╝\n\n");
+  
+  // KV store first - WiFi, time and switches read their state from it
+  kvBegin();
+  autoPollInterval = kvGetU32(KV_AUTO_POLL_MS, AUTO_POLL_INTERVAL_MS);
   
-  WiFi.setSleep(false);
   WiFi.setAutoReconnect(true);
   ensureWiFi();
   
   timeClientBegin();
   switchesBegin();
   sensorsBegin();
+  samplerBegin();
+  aggBegin();
+  anomalyBegin();
+  messagingBegin();
   ledsBegin();
   controlBegin();
+  powerBegin();     // After the modules whose state it restores
+  poolBegin();      // Last: its baseline is the heap after setup
+  schedBegin();
+  applyPowerPeriods();
   
-  Serial.print("\n[INIT] Free Heap: ");
-  Serial.print(ESP.getFreeHeap());
-  Serial.println(" bytes");
+  LOGI("INIT", "Free Heap: %lu bytes", (unsigned long)ESP.getFreeHeap());
   
-  Serial.println("\n╔════════════════════════════════════════════════╗");
-  Serial.println("║              SYSTEM READY                      ║");
-  Serial.println("╠════════════════════════════════════════════════╣");
-  Serial.println("║  Button 1: Log + Notify (auto-restart if low) ║");
-  Serial.println("║  Button 2: Check LED/RGB Status               ║");
-  Serial.println("║                                                ║");
-  Serial.println("║  Commands:                                     ║");
-  Serial.println("║  Type 'M': Memory status                      ║");
-  Serial.println("║  Type 'R': Manual restart                     ║");
-  Serial.println("║  Type 'A': Toggle auto-restart                ║");
-  Serial.println("║                                                ║");
-  Serial.println("║  Auto-Poll: Every 10 seconds ✓                ║");
-  Serial.println("╚════════════════════════════════════════════════╝\n");
+  CONSOLE("\n╔════════════════════════════════════════════════╗\n");
+  CONSOLE("║              SYSTEM READY                      ║\n");
+  CONSOLE("╠════════════════════════════════════════════════╣\n");
+  CONSOLE("║  Button 1: Log + Notify (auto-restart if low) ║\n");
+  CONSOLE("║  Button 2: Check LED/RGB Status               ║\n");
+  CONSOLE("║                                                ║\n");
+  CONSOLE("║  Commands:                                     ║\n");
+  CONSOLE("║  Type 'M': Memory status                      ║\n");
+  CONSOLE("║  Type 'R': Manual restart                     ║\n");
+  CONSOLE("║  Type 'A': Toggle auto-restart                ║\n");
+  CONSOLE("║  Type 'K': KV store / flash wear stats        ║\n");
+  CONSOLE("║  Type 'D': Sensor / sampler / window counters ║\n");
+  CONSOLE("║  Type 'G': GPIO HAL benchmark                 ║\n");
+  CONSOLE("║  Type 'T': Task scheduler profile             ║\n");
+  CONSOLE("║  Type 'P': Latency percentiles (and reset)    ║\n");
+  CONSOLE("║  Type 'H': Heap per module, pools, trend      ║\n");
+  CONSOLE("║  Type 'W': Power / charge model               ║\n");
+  CONSOLE("║  Type 'S': Cycle power mode                   ║\n");
+  CONSOLE("║  Type 'I<ms>': Auto-poll interval (saved)     ║\n");
+  CONSOLE("║  Type 'B<ms>': Switch debounce (saved)        ║\n");
+  CONSOLE("║  Type 'N<ms>': Aggregation window (saved)     ║\n");
+  CONSOLE("║                                                ║\n");
+  CONSOLE("║  Auto-Poll: Every %-6lu ms ✓                 ║\n", autoPollInterval);
+  CONSOLE("╚════════════════════════════════════════════════╝\n\n");
   
   blinkAsync(PIN_LED1, 100, 300);
   delay(400);
@@ -342,98 +669,6 @@ void setup() {
 // Main Loop
 // ============================================================================
 void loop() {
-  serialMenu();
-  pollSwitches();
-  ledsPoll();
-  handleAutoPoll();
-  
-  // ══════════════════════════════════════════════════════════════
-  // BUTTON 1 with Memory Check & Auto-Restart
-  // ══════════════════════════════════════════════════════════════
-  if (takeSwitch1Event()) {
-    Serial.println("\n\n");
-    Serial.println("╔════════════════════════════════════════════════╗");
-    Serial.println("║      BUTTON 1: SENSOR LOGGING EVENT            ║");
-    Serial.println("╚════════════════════════════════════════════════╝\n");
-    
-    // Check memory FIRST - restart if needed
-    if (!checkMemoryAndRestart()) {
-      Serial.println("⚠ Continuing with low memory (likely to fail)\n");
-    }
-    
-    String timestamp;
-    float temperature = 0.0;
-    float humidity = 0.0;
-    bool sensorsOk = true;
-    
-    Serial.println("═══ [1/5] TIMESTAMP ═══");
-    if (!readTimeISO(timestamp)) {
-      timestamp = "2025-11-04 00:00:00";
-      sensorsOk = false;
-    } else {
-      Serial.print("✓ ");
-      Serial.println(timestamp);
-    }
-    
-    Serial.println("\n═══ [2/5] DHT11 ═══");
-    if (!readDHT(temperature, humidity)) {
-      sensorsOk = false;
-    } else {
-      Serial.print("✓ ");
-      Serial.print(temperature, 1);
-      Serial.print("°C, ");
-      Serial.print(humidity, 1);
-      Serial.println("%");
-    }
-    
-    Serial.println("\n═══ [3/5] DATABASE ═══");
-    bool dbSuccess = false;
-    if (sensorsOk) {
-      uint32_t cnt = switch1Count() + 1;
-      dbSuccess = transmitToDatabase(timestamp, temperature, humidity, cnt);
-      if (dbSuccess) incSwitch1();
-    }
-    
-    delay(500);
-    
-    Serial.println("\n═══ [4/5] IFTTT ═══");
-    bool notifySuccess = false;
-    if (sensorsOk) {
-      notifySuccess = sendIFTTTNotification("node_1", temperature, humidity);
-    }
-    
-    Serial.println("\n═══ [5/5] VISUAL ═══");
-    blinkAsync(PIN_LED1, 250, 2000);
-    
-    Serial.println("\n╔════════════════════════════════════════════════╗");
-    Serial.println("║               SUMMARY                          ║");
-    Serial.println("╠════════════════════════════════════════════════╣");
-    Serial.print("║  Sensors:  ");
-    Serial.println(sensorsOk ? "✓ OK    ║" : "✗ FAIL  ║");
-    Serial.print("║  Database: ");
-    Serial.println(dbSuccess ? "✓ OK    ║" : "✗ FAIL  ║");
-    Serial.print("║  IFTTT:    ");
-    Serial.println(notifySuccess ? "✓ OK    ║" : "✗ FAIL  ║");
-    Serial.println("╚════════════════════════════════════════════════╝\n");
-    
-    if (!dbSuccess || !notifySuccess) {
-      Serial.println("💡 System will auto-restart before next Button 1");
-      Serial.println("   to ensure enough memory for SSL\n");
-    }
-  }
-  
-  // ══════════════════════════════════════════════════════════════
-  // BUTTON 2
-  // ══════════════════════════════════════════════════════════════
-  if (takeSwitch2Event()) {
-    Serial.println("\n[BUTTON 2] Status check...");
-    pollLEDControl();
-    pollRGBControl();
-    Serial.println(getLEDStatusString());
-    Serial.println(getRGBStatusString());
-    blinkAsync(PIN_LED2, 250, 2000);
-    incSwitch2();
-  }
-  
-  delay(10);
+  // Runs whatever is due, then sleeps until the next deadline or input
+  schedRun();
 }
@@ -0,0 +1,150 @@
+// ============================================================================
+// mem_pool.cpp - Size-Class Pool Implementation
+// ============================================================================
+
+#include "mem_pool.h"
+#include "config.h"
+#include "logger.h"
+
+static const uint16_t classSize[POOL_CLASS_COUNT] = {64, 256, 1024, 4096};
+static const uint16_t classBlocks[POOL_CLASS_COUNT] = {
+  POOL_64_BLOCKS, POOL_256_BLOCKS, POOL_1K_BLOCKS, POOL_4K_BLOCKS
+};
+
+static const size_t ARENA_BYTES = POOL_64_BLOCKS * 64UL + POOL_256_BLOCKS * 256UL +
+                                  POOL_1K_BLOCKS * 1024UL + POOL_4K_BLOCKS * 4096UL;
+
+// Blocks are laid out class by class; +8 keeps the array non-empty
+alignas(8) static uint8_t arena[ARENA_BYTES + 8];
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+static FreeBlock* freeList[POOL_CLASS_COUNT];
+static uint8_t* classStart[POOL_CLASS_COUNT + 1];
+static PoolStats stats[POOL_CLASS_COUNT];
+static uint32_t oversize = 0;          // Larger than the biggest class
+static uint32_t heapFailures = 0;      // Heap fallback returned NULL
+static uint32_t baselineMaxBlock = 0;
+static bool ready = false;
+
+PoolJsonAllocator jsonPool;
+
+/**
+ * Class of a pool pointer, or POOL_CLASS_COUNT for heap memory
+ */
+static uint8_t classOf(const void* ptr) {
+  const uint8_t* p = (const uint8_t*)ptr;
+  if (!ready || p < classStart[0] || p >= classStart[POOL_CLASS_COUNT]) {
+    return POOL_CLASS_COUNT;
+  }
+  uint8_t c = 0;
+  while (p >= classStart[c + 1]) c++;
+  return c;
+}
+
+void poolBegin() {
+  uint8_t* p = arena;
+  for (uint8_t c = 0; c < POOL_CLASS_COUNT; c++) {
+    classStart[c] = p;
+    freeList[c] = nullptr;
+    // Thread back to front so the first allocation gets the lowest block
+    for (int16_t i = classBlocks[c] - 1; i >= 0; i--) {
+      FreeBlock* b = (FreeBlock*)(p + (size_t)i * classSize[c]);
+      b->next = freeList[c];
+      freeList[c] = b;
+    }
+    p += (size_t)classBlocks[c] * classSize[c];
+    memset(&stats[c], 0, sizeof(stats[c]));
+    stats[c].blocks = classBlocks[c];
+  }
+  classStart[POOL_CLASS_COUNT] = p;
+  ready = true;
+  baselineMaxBlock = ESP.getMaxFreeBlockSize();
+
+  LOGI("POOL", "%u B reserved, largest free heap block %lu B",
+       (unsigned)ARENA_BYTES, (unsigned long)baselineMaxBlock);
+}
+
+void* poolAlloc(size_t size) {
+  uint8_t want = 0;
+  while (want < POOL_CLASS_COUNT && classSize[want] < size) want++;
+
+  if (ready && want < POOL_CLASS_COUNT) {
+    for (uint8_t c = want; c < POOL_CLASS_COUNT; c++) {
+      FreeBlock* b = freeList[c];
+      if (!b) continue;
+      freeList[c] = b->next;
+      PoolStats& s = stats[c];
+      s.allocs++;
+      if (++s.inUse > s.highWater) s.highWater = s.inUse;
+      if (c != want) stats[want].spills++;
+      return b;
+    }
+  }
+
+  if (want < POOL_CLASS_COUNT) {
+    if (ready) stats[want].heapFallbacks++;
+  } else {
+    oversize++;
+  }
+  void* p = malloc(size);
+  if (!p) heapFailures++;
+  return p;
+}
+
+void poolFree(void* ptr) {
+  if (!ptr) return;
+  uint8_t c = classOf(ptr);
+  if (c == POOL_CLASS_COUNT) {
+    free(ptr);
+    return;
+  }
+  FreeBlock* b = (FreeBlock*)ptr;
+  b->next = freeList[c];
+  freeList[c] = b;
+  stats[c].inUse--;
+}
+
+void* poolRealloc(void* ptr, size_t size) {
+  if (!ptr) return poolAlloc(size);
+  if (size == 0) {
+    poolFree(ptr);
+    return nullptr;
+  }
+
+  uint8_t c = classOf(ptr);
+  if (c == POOL_CLASS_COUNT) return realloc(ptr, size);   // Stays on the heap
+  if (size <= classSize[c]) return ptr;
+
+  void* p = poolAlloc(size);
+  if (!p) return nullptr;                 // Old block is still valid
+  memcpy(p, ptr, classSize[c]);
+  poolFree(ptr);
+  return p;
+}
+
+size_t poolBlockSize(const void* ptr) {
+  uint8_t c = classOf(ptr);
+  return c < POOL_CLASS_COUNT ? classSize[c] : 0;
+}
+
+const PoolStats& poolStats(PoolClass c) {
+  return stats[c < POOL_CLASS_COUNT ? c : POOL_64];
+}
+
+void poolPrintStats() {
+  CONSOLE("\n[POOL] Size-class pools (%u B reserved):\n", (unsigned)ARENA_BYTES);
+  CONSOLE("  Block  Count  InUse   Peak     Allocs  Spills    Heap\n");
+  for (uint8_t c = 0; c < POOL_CLASS_COUNT; c++) {
+    const PoolStats& s = stats[c];
+    CONSOLE("  %5u %6u %6u %6u %10lu %7lu %7lu\n",
+            classSize[c], s.blocks, s.inUse, s.highWater, (unsigned long)s.allocs,
+            (unsigned long)s.spills, (unsigned long)s.heapFallbacks);
+  }
+  CONSOLE("  Oversize requests: %lu, heap failures: %lu\n",
+          (unsigned long)oversize, (unsigned long)heapFailures);
+  CONSOLE("  Largest free heap block: %lu B (%lu B after setup)\n",
+          (unsigned long)ESP.getMaxFreeBlockSize(), (unsigned long)baselineMaxBlock);
+}
@@ -0,0 +1,133 @@
+// ============================================================================
+// mem_pool.h - Fixed-Block Size-Class Memory Pools
+// ============================================================================
+// Purpose: Keep per-request scratch memory (JSON documents, HTTP client
+//          objects, payload and response buffers) off the general heap so
+//          it cannot fragment the largest free block SSL needs
+// Layout: One static arena, carved at poolBegin() into 64 / 256 / 1024 /
+//         4096-byte blocks (counts in config.h). Each class is a free list;
+//         allocate and free are O(1) and never split or merge.
+// Policy: Smallest class that fits; if it is exhausted, the next larger
+//         class (a spill); if all are, the heap (counted - size the pools
+//         so this stays at zero). Pointers are routed back by address.
+// Users: PoolJsonAllocator for JsonDocument, poolNew()/poolDelete() for
+//        objects, PoolString for StringBuffer scratch
+// Context: CONT only - not for ISRs
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <new>
+#include <utility>
+#include "static_string.h"
+
+enum PoolClass : uint8_t {
+  POOL_64 = 0,
+  POOL_256,
+  POOL_1K,
+  POOL_4K,
+  POOL_CLASS_COUNT
+};
+
+/**
+ * Per-class counters
+ */
+struct PoolStats {
+  uint16_t blocks;         // Reserved at boot
+  uint16_t inUse;
+  uint16_t highWater;      // Most blocks in use at once
+  uint32_t allocs;
+  uint32_t spills;         // Requests for this class served by a larger one
+  uint32_t heapFallbacks;  // Requests for this class served by malloc()
+};
+
+/**
+ * Carve the arena into blocks and remember the largest free heap block
+ * as the baseline. Call once at the end of setup(); until then
+ * poolAlloc() uses the heap.
+ */
+void poolBegin();
+
+/**
+ * Block of at least size bytes (heap if no pool block is left,
+ * nullptr only if that fails too)
+ */
+void* poolAlloc(size_t size);
+
+/**
+ * Release a block from poolAlloc() (heap pointers go to free())
+ */
+void poolFree(void* ptr);
+
+/**
+ * Grow or shrink; stays in place while the block is big enough
+ */
+void* poolRealloc(void* ptr, size_t size);
+
+/**
+ * Usable size of a pool block, 0 for anything else
+ */
+size_t poolBlockSize(const void* ptr);
+
+const PoolStats& poolStats(PoolClass c);
+
+/**
+ * Print per-class usage, high-water marks, spills and heap fallbacks
+ */
+void poolPrintStats();
+
+/**
+ * Construct / destroy an object in a pool block
+ */
+template <typename T, typename... Args>
+T* poolNew(Args&&... args) {
+  void* p = poolAlloc(sizeof(T));
+  return p ? new (p) T(std::forward<Args>(args)...) : nullptr;
+}
+
+template <typename T>
+void poolDelete(T* obj) {
+  if (!obj) return;
+  obj->~T();
+  poolFree(obj);
+}
+
+/**
+ * unique_ptr deleter for poolNew() objects
+ */
+struct PoolDeleter {
+  template <typename T>
+  void operator()(T* obj) const { poolDelete(obj); }
+};
+
+/**
+ * JSON document memory from the pools: JsonDocument doc(&jsonPool);
+ */
+class PoolJsonAllocator : public ArduinoJson::Allocator {
+ public:
+  void* allocate(size_t size) override { return poolAlloc(size); }
+  void deallocate(void* ptr) override { poolFree(ptr); }
+  void* reallocate(void* ptr, size_t size) override { return poolRealloc(ptr, size); }
+};
+
+extern PoolJsonAllocator jsonPool;
+
+/**
+ * StringBuffer of the given capacity leased from the pools for its
+ * lifetime. Capacity 0 (every append truncates) if nothing is left.
+ */
+class PoolString : public StringBuffer {
+ public:
+  explicit PoolString(size_t size) : PoolString((char*)poolAlloc(size), size) {}
+  ~PoolString() { poolFree(block_); }
+  PoolString(const PoolString&) = delete;
+  PoolString& operator=(const PoolString&) = delete;
+
+ private:
+  PoolString(char* block, size_t size)
+      : StringBuffer(block ? block : &none_, block ? size : 1), block_(block) {}
+
+  char* block_;
+  char none_;
+};
@@ -4,13 +4,17 @@
 
 #include "messaging.h"
 #include "config.h"
+#include "logger.h"
 #include "net.h"
+#include "heap_trace.h"
+#include "static_string.h"
+#include "mem_pool.h"
 #include <ESP8266HTTPClient.h>
 #include <WiFiClientSecure.h>
 
 // Message queue structure
 struct Message {
-  String content;
+  StaticString<MESSAGE_MAX_LEN> content;
   uint32_t timestamp;
   uint8_t retries;
   bool pending;
@@ -20,6 +24,9 @@ static Message messageQueue[MAX_MESSAGE_QUEUE];
 static uint8_t queueHead = 0;
 static uint8_t queueTail = 0;
 static uint8_t queueSize = 0;
+static uint32_t nextAttempt = 0;
+
+static_assert(MESSAGE_POST_MAX >= MESSAGE_MAX_LEN + 16, "A post must hold at least one message");
 
 /**
  * Initialize messaging module
@@ -30,18 +37,21 @@ void messagingBegin() {
     messageQueue[i].pending = false;
     messageQueue[i].retries = 0;
   }
-  Serial.println("[MESSAGING] Module initialized");
+  LOGI("MESSAGING", "Module initialized");
 }
 
 /**
  * Add message to queue
  */
-static bool enqueueMessage(const String& message) {
+static bool enqueueMessage(const StringBuffer& message) {
   if (queueSize >= MAX_MESSAGE_QUEUE) {
-    Serial.println("[MESSAGING] Queue full - message dropped");
+    LOGW("MESSAGING", "Queue full - message dropped");
     return false;
   }
 
+  if (message.truncated()) {
+    LOGW("MESSAGING", "Message cut at MESSAGE_MAX_LEN");
+  }
   messageQueue[queueTail].content = message;
   messageQueue[queueTail].timestamp = millis();
   messageQueue[queueTail].retries = 0;
@@ -50,9 +60,7 @@ static bool enqueueMessage(const String& message) {
   queueTail = (queueTail + 1) % MAX_MESSAGE_QUEUE;
   queueSize++;
 
-  Serial.print("[MESSAGING] Message queued (");
-  Serial.print(queueSize);
-  Serial.println(" pending)");
+  LOGI("MESSAGING", "Message queued (%u pending)", queueSize);
   return true;
 }
 
@@ -72,9 +80,9 @@ static void dequeueMessage() {
  * NOTE: You need to configure your Slack webhook URL
  * This is a placeholder - replace with actual Slack integration
  */
-static bool sendSlackMessage(const String& message) {
+static bool sendSlackMessage(const StringBuffer& payload) {
   if (!ensureWiFi()) {
-    Serial.println("[MESSAGING] No WiFi for Slack");
+    LOGE("MESSAGING", "No WiFi for Slack");
     return false;
   }
 
@@ -88,25 +96,19 @@ static bool sendSlackMessage(const String& message) {
   http.setTimeout(10000);
 
   if (!http.begin(client, SLACK_WEBHOOK)) {
-    Serial.println("[MESSAGING] Slack HTTP begin failed");
+    LOGE("MESSAGING", "Slack HTTP begin failed");
     return false;
   }
 
   http.addHeader("Content-Type", "application/json");
 
-  // Format Slack payload
-  String payload = "{\"text\":\"";
-  payload += message;
-  payload += "\"}";
-
-  int code = http.POST(payload);
+  int code = http.POST((const uint8_t*)payload.c_str(), payload.length());
   bool success = (code == HTTP_CODE_OK || code == 200);
 
   if (success) {
-    Serial.println("[MESSAGING] ✓ Slack message sent");
+    LOGI("MESSAGING", "Slack message sent");
   } else {
-    Serial.print("[MESSAGING] ✗ Slack error: ");
-    Serial.println(code);
+    LOGE("MESSAGING", "Slack error: %d", code);
   }
 
   http.end();
@@ -116,18 +118,24 @@ static bool sendSlackMessage(const String& message) {
 /**
  * Send sensor data notification
  */
-bool sendSensorNotification(uint8_t node, const String& timestamp,
+bool sendSensorNotification(uint8_t node, StringView timestamp,
                             float tempC, float humidity, uint32_t count) {
-  String message = "🌡️ Sensor Reading - Node ";
-  message += String(node);
+  StaticString<MESSAGE_MAX_LEN> message = "🌡️ Sensor Reading - Node ";
+  message.print(node);
+  message += "\\n";
+  message += "Time: ";
+  message += timestamp;
   message += "\\n";
-  message += "Time: " + timestamp + "\\n";
-  message += "Temperature: " + String(tempC, 1) + "°C\\n";
-  message += "Humidity: " + String(humidity, 1) + "%\\n";
-  message += "Activity Count: " + String(count);
+  message += "Temperature: ";
+  message.print(tempC, 1);
+  message += "°C\\n";
+  message += "Humidity: ";
+  message.print(humidity, 1);
+  message += "%\\n";
+  message += "Activity Count: ";
+  message.print(count);
 
-  Serial.println("[MESSAGING] Sensor notification:");
-  Serial.println(message);
+  LOGD("MESSAGING", "Sensor notification: %s", message.c_str());
 
   return enqueueMessage(message);
 }
@@ -135,47 +143,64 @@ bool sendSensorNotification(uint8_t node, const String& timestamp,
 /**
  * Send LED/RGB status notification
  */
-bool sendStatusNotification(const String& ledStatus, const String& rgbStatus) {
-  String message = "💡 Status Check\\n";
-  message += ledStatus + "\\n";
+bool sendStatusNotification(StringView ledStatus, StringView rgbStatus) {
+  StaticString<MESSAGE_MAX_LEN> message = "💡 Status Check\\n";
+  message += ledStatus;
+  message += "\\n";
   message += rgbStatus;
 
-  Serial.println("[MESSAGING] Status notification:");
-  Serial.println(message);
+  LOGD("MESSAGING", "Status notification: %s", message.c_str());
 
   return enqueueMessage(message);
 }
 
 /**
  * Process pending messages
+ * Routine messages are low priority: they are held until a batch is full
+ * or the oldest one is due, then sent as a single Slack post
  */
 void messagingPoll() {
   if (queueSize == 0) return;
+  HEAP_SCOPE(HT_MESSAGING);
 
-  // Get the oldest pending message
-  Message& msg = messageQueue[queueHead];
-  if (!msg.pending) {
-    dequeueMessage();
+  uint32_t now = millis();
+  if (queueSize < MESSAGE_BATCH_SIZE &&
+      now - messageQueue[queueHead].timestamp < MESSAGE_BATCH_MS) {
     return;
   }
+  if ((int32_t)(now - nextAttempt) < 0) return;   // Retry back-off
+
+  // Join as many queued messages as fit into one post; the rest wait for
+  // the next one
+  static const char OPEN[] = "{\"text\":\"";
+  static const char SEPARATOR[] = "\\n\\n";
+  static const char CLOSE[] = "\"}";
+  PoolString post(MESSAGE_POST_MAX);
+  if (post.capacity() < MESSAGE_POST_MAX - 1) return;   // Out of memory - next poll
+  post += OPEN;
+  uint8_t batched = 0;
+  while (batched < queueSize) {
+    const Message& m = messageQueue[(queueHead + batched) % MAX_MESSAGE_QUEUE];
+    size_t need = m.content.length() + (batched ? sizeof(SEPARATOR) - 1 : 0);
+    if (batched && post.length() + need + sizeof(CLOSE) - 1 > post.capacity()) break;
+    if (batched) post += SEPARATOR;
+    post += m.content;
+    batched++;
+  }
+  post += CLOSE;
 
-  // Attempt to send
-  if (sendSlackMessage(msg.content)) {
-    Serial.print("[MESSAGING] ✓ Message sent (");
-    Serial.print(queueSize - 1);
-    Serial.println(" remaining)");
-    dequeueMessage();
+  Message& msg = messageQueue[queueHead];
+  if (sendSlackMessage(post)) {
+    LOGI("MESSAGING", "Batch of %u sent", batched);
+    while (batched--) dequeueMessage();
   } else {
     msg.retries++;
     if (msg.retries >= 3) {
-      Serial.println("[MESSAGING] ✗ Message failed after 3 retries - dropping");
-      dequeueMessage();
+      LOGE("MESSAGING", "Batch failed after 3 retries - dropping");
+      while (batched--) dequeueMessage();
     } else {
-      Serial.print("[MESSAGING] Retry ");
-      Serial.print(msg.retries);
-      Serial.println("/3");
-      // Wait before retry
-      delay(1000);
+      LOGW("MESSAGING", "Retry %u/3", msg.retries);
+      nextAttempt = now + MESSAGE_RETRY_MS;
     }
   }
 }
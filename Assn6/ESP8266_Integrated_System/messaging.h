@@ -2,11 +2,14 @@
 // messaging.h - Slack and SMS Notification Interface
 // ============================================================================
 // Purpose: Send status notifications via Slack and SMS
-// Features: Message buffering, retry logic, formatted status messages
+// Features: Message buffering, batched low-priority delivery (one post per
+//           MESSAGE_BATCH_SIZE messages or MESSAGE_BATCH_MS), retry back-off,
+//           formatted status messages
 // ============================================================================
 
 #pragma once
 #include <Arduino.h>
+#include "static_string.h"
 
 /**
  * Initialize messaging module
@@ -22,7 +25,7 @@ void messagingBegin();
  * @param count Activity count
  * @return true if message sent successfully
  */
-bool sendSensorNotification(uint8_t node, const String& timestamp, 
+bool sendSensorNotification(uint8_t node, StringView timestamp,
                             float tempC, float humidity, uint32_t count);
 
 /**
@@ -31,10 +34,10 @@ bool sendSensorNotification(uint8_t node, const String& timestamp,
  * @param rgbStatus RGB status string (e.g., "RGB(255,0,0)")
  * @return true if message sent successfully
  */
-bool sendStatusNotification(const String& ledStatus, const String& rgbStatus);
+bool sendStatusNotification(StringView ledStatus, StringView rgbStatus);
 
 /**
- * Process any pending messages in the queue
+ * Send queued messages as one batch once the batch is full or due
  * Call regularly from main loop
  */
 void messagingPoll();
@@ -3,13 +3,31 @@
 // ============================================================================
 // Purpose: WiFi connection management implementation
 // Features: Automatic connection with 15-second timeout, reconnection support
+//           Fast reconnect using the AP channel/BSSID cached in the KV store
 // Used by: control.cpp, messaging.cpp, time_client.cpp, tx.cpp
 // ============================================================================
 
 #include "net.h"
 #include "config.h"
+#include "kvstore.h"
+#include "heap_trace.h"
+#include "logger.h"
 #include <ESP8266WiFi.h>
 
+// Time allowed for a cached channel/BSSID connect before full scan
+static const uint32_t FAST_CONNECT_TIMEOUT_MS = 5000;
+
+/**
+ * Wait for connection up to timeoutMs
+ */
+static bool waitForWiFi(uint32_t timeoutMs) {
+  uint32_t start = millis();
+  while (!isWiFiUp() && millis() - start < timeoutMs) {
+    delay(300);
+  }
+  return isWiFiUp();
+}
+
 /**
  * Check if WiFi is currently connected
  */
@@ -26,28 +44,45 @@ bool ensureWiFi() {
   if (isWiFiUp()) {
     return true;
   }
+  HEAP_SCOPE(HT_NET);
   
   // Attempt connection
-  Serial.print("[WiFi] Connecting to ");
-  Serial.print(WIFI_SSID);
-  Serial.print("...");
+  LOGI("WiFi", "Connecting to %s...", WIFI_SSID);
   
+  // No SDK config saves to flash: the ADC timer ISR runs flash code and
+  // is only paused around the KV store's own flash accesses
+  WiFi.persistent(false);
   WiFi.mode(WIFI_STA);
-  WiFi.begin(WIFI_SSID, WIFI_PASS);
   
-  uint32_t start = millis();
-  while (!isWiFiUp() && millis() - start < 15000) {
-    delay(300);
-    Serial.print(".");
+  // Try the cached AP first - skips the channel scan
+  uint8_t channel = 0;
+  uint8_t bssid[6];
+  bool fast = kvGet(KV_WIFI_CHANNEL, &channel, 1) == 1 &&
+              kvGet(KV_WIFI_BSSID, bssid, sizeof(bssid)) == sizeof(bssid);
+  
+  if (fast) {
+    WiFi.begin(WIFI_SSID, WIFI_PASS, channel, bssid);
+    if (!waitForWiFi(FAST_CONNECT_TIMEOUT_MS)) {
+      LOGW("WiFi", "Cached AP failed - full scan");
+      WiFi.begin(WIFI_SSID, WIFI_PASS);
+      waitForWiFi(15000 - FAST_CONNECT_TIMEOUT_MS);
+    }
+  } else {
+    WiFi.begin(WIFI_SSID, WIFI_PASS);
+    waitForWiFi(15000);
   }
-  Serial.println();
   
   if (isWiFiUp()) {
-    Serial.print("[WiFi] Connected! IP: ");
-    Serial.println(WiFi.localIP());
+    IPAddress ip = WiFi.localIP();
+    LOGI("WiFi", "Connected! IP: %u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    
+    // Cache AP parameters (no flash write if unchanged)
+    channel = (uint8_t)WiFi.channel();
+    kvPut(KV_WIFI_CHANNEL, &channel, 1);
+    kvPut(KV_WIFI_BSSID, WiFi.BSSID(), 6);
     return true;
   } else {
-    Serial.println("[WiFi] Connection failed (timeout 15s)");
+    LOGE("WiFi", "Connection failed (timeout 15s)");
     return false;
   }
 }
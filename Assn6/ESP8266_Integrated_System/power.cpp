@@ -0,0 +1,259 @@
+// ============================================================================
+// power.cpp - Power Manager Implementation
+// ============================================================================
+// Light sleep is the SDK's automatic mode: with WIFI_LIGHT_SLEEP selected it
+// may gate the CPU while loop() waits in esp_delay(), which is where the
+// scheduler spends its idle time - if no timer is due too soon. Nothing
+// here blocks.
+// ============================================================================
+
+#include "power.h"
+#include "config.h"
+#include "logger.h"
+#include "kvstore.h"
+#include "task_sched.h"
+#include "switches.h"
+#include "events.h"
+#include "leds.h"
+#include "adc_acquire.h"
+#include "inputs.h"
+#include <ESP8266WiFi.h>
+#include <coredecls.h>
+#include <sys/time.h>
+#include <time.h>
+
+extern "C" {
+#include <user_interface.h>
+}
+
+// Deep-sleep wake resets through GPIO16 -> RST, so nothing else may use GPIO16
+#if POWER_DEEP_ENABLE && PIN_SWITCH_2 == 16
+#error "POWER_DEEP needs GPIO16 wired to RST, but GPIO16 is PIN_SWITCH_2 - move Switch 2 first"
+#endif
+static_assert(POWER_DEFAULT_MODE != POWER_DEEP || POWER_DEEP_ENABLE,
+              "POWER_DEFAULT_MODE 2 needs POWER_DEEP_ENABLE");
+
+static const uint32_t RTC_MAGIC = 0x50575231;   // "PWR1"
+static const uint32_t RTC_OFFSET = 0;           // 4-byte blocks into user RTC memory
+
+/**
+ * State kept in RTC memory across deep sleep
+ */
+struct RtcState {
+  uint32_t magic;
+  uint32_t crc;            // Over everything after this field
+  uint32_t epochAtSleep;   // Clock anchor: time() when going to sleep (0 = unset)
+  uint32_t sleepMs;        // Planned sleep length
+  uint32_t switch1Count;
+  uint32_t switch2Count;
+  uint32_t eventSeq;
+  uint8_t ledMask;         // Bit 0 = LED1, bit 1 = LED2
+  uint8_t rgb[3];
+  PowerStats stats;
+};
+static_assert(sizeof(RtcState) % 4 == 0, "RTC memory is accessed in 4-byte blocks");
+static_assert(sizeof(RtcState) <= 512 - RTC_OFFSET * 4, "RTC user memory is 512 bytes");
+
+// Assumed idle current per mode (deep mode idles in light sleep while awake)
+static const uint32_t idleUa[POWER_MODE_COUNT] = {
+  POWER_UA_IDLE_ACTIVE,
+  POWER_UA_IDLE_LIGHT,
+  POWER_UA_IDLE_LIGHT
+};
+static const char* const modeNames[POWER_MODE_COUNT] = {"active", "light sleep", "deep sleep"};
+
+static PowerMode mode = POWER_ACTIVE;
+static PowerStats stats = {0, 0, 0, 0, 0, 0};
+static bool deepWake = false;
+
+// Accounting checkpoint
+static uint32_t lastMs = 0;
+static uint32_t lastSleptMs = 0;
+
+static uint32_t rtcCrc(const RtcState& s) {
+  const uint8_t* p = (const uint8_t*)&s + offsetof(RtcState, epochAtSleep);
+  return crc32(p, sizeof(RtcState) - offsetof(RtcState, epochAtSleep));
+}
+
+/**
+ * Fold the time since the last checkpoint into the charge total
+ */
+static void accumulate() {
+  uint32_t now = millis();
+  uint32_t slept = schedSleptMs();
+  uint32_t idle = slept - lastSleptMs;
+  uint32_t elapsed = now - lastMs;
+  uint32_t busy = elapsed > idle ? elapsed - idle : 0;
+  lastMs = now;
+  lastSleptMs = slept;
+
+  stats.busyMs += busy;
+  stats.idleMs += idle;
+  stats.chargeUAms += (uint64_t)busy * POWER_UA_BUSY + (uint64_t)idle * idleUa[mode];
+}
+
+static void applyMode() {
+  if (mode == POWER_ACTIVE) {
+    WiFi.setSleepMode(WIFI_NONE_SLEEP);
+  } else {
+    WiFi.setSleepMode(WIFI_LIGHT_SLEEP, POWER_LISTEN_INTERVAL);
+    wifi_enable_gpio_wakeup(GPIO_ID_PIN(PIN_SWITCH_1), GPIO_PIN_INTR_LOLEVEL);
+  }
+
+  // The timer0 tick wakes the CPU - run it slower outside active mode
+  if (adcAcqSetRate(mode == POWER_ACTIVE ? ADC_SAMPLE_HZ : POWER_ADC_SAMPLE_HZ)) {
+    inputsRetime();
+  }
+}
+
+/**
+ * Restore the snapshot taken before deep sleep (or a reset)
+ */
+static bool restoreState() {
+  RtcState s;
+  if (!ESP.rtcUserMemoryRead(RTC_OFFSET, (uint32_t*)&s, sizeof(s))) return false;
+  if (s.magic != RTC_MAGIC || s.crc != rtcCrc(s)) return false;
+
+  stats = s.stats;
+  if (deepWake) {
+    stats.deepWakes++;
+    stats.deepMs += s.sleepMs;
+    stats.chargeUAms += (uint64_t)s.sleepMs * POWER_UA_DEEP;
+  }
+
+  // Clock anchor - timestamps are valid before NTP answers
+  if (deepWake && s.epochAtSleep) {
+    struct timeval tv = {(time_t)(s.epochAtSleep + (s.sleepMs + millis()) / 1000), 0};
+    settimeofday(&tv, nullptr);
+  }
+
+  switchesRestoreCounts(s.switch1Count, s.switch2Count);
+  eventRestoreSeq(s.eventSeq);
+  setLED(PIN_LED1, s.ledMask & 1);
+  setLED(PIN_LED2, s.ledMask & 2);
+  setRGBColor(s.rgb[0], s.rgb[1], s.rgb[2]);
+  return true;
+}
+
+static void saveState(uint32_t sleepMs) {
+  accumulate();
+
+  RtcState s;
+  memset(&s, 0, sizeof(s));
+  s.magic = RTC_MAGIC;
+  time_t now = time(nullptr);
+  s.epochAtSleep = (now >= 1000000000) ? (uint32_t)now : 0;
+  s.sleepMs = sleepMs;
+  s.switch1Count = switch1Count();
+  s.switch2Count = switch2Count();
+  s.eventSeq = eventNextSeq();
+  s.ledMask = (getLED(PIN_LED1) ? 1 : 0) | (getLED(PIN_LED2) ? 2 : 0);
+  int r, g, b;
+  getRGBColor(r, g, b);
+  s.rgb[0] = r;
+  s.rgb[1] = g;
+  s.rgb[2] = b;
+  s.stats = stats;
+  s.crc = rtcCrc(s);
+  ESP.rtcUserMemoryWrite(RTC_OFFSET, (uint32_t*)&s, sizeof(s));
+}
+
+void powerBegin() {
+  const rst_info* ri = system_get_rst_info();
+  deepWake = ri && ri->reason == REASON_DEEP_SLEEP_AWAKE;
+
+  uint8_t m = POWER_DEFAULT_MODE;
+  kvGet(KV_POWER_MODE, &m, 1);
+  mode = powerModeAvailable((PowerMode)m) ? (PowerMode)m : POWER_ACTIVE;
+  applyMode();
+
+  bool restored = restoreState();
+
+  if (deepWake) {
+    LOGI("POWER", "Mode: %s (deep-sleep wake #%lu)%s", modeNames[mode],
+         (unsigned long)stats.deepWakes, restored ? ", RTC state restored" : "");
+  } else {
+    LOGI("POWER", "Mode: %s%s", modeNames[mode], restored ? ", RTC state restored" : "");
+  }
+}
+
+void powerSetMode(PowerMode m) {
+  if (!powerModeAvailable(m)) {
+    LOGW("POWER", "Mode %u not available (POWER_DEEP_ENABLE, config.h)", m);
+    return;
+  }
+  accumulate();                 // Charge so far at the old mode's current
+  mode = m;
+  uint8_t v = m;
+  kvPut(KV_POWER_MODE, &v, 1);
+  applyMode();
+
+  LOGI("POWER", "Mode: %s", modeNames[mode]);
+}
+
+PowerMode powerMode() {
+  return mode;
+}
+
+bool powerModeAvailable(PowerMode m) {
+  if (m == POWER_DEEP) return POWER_DEEP_ENABLE;
+  return m < POWER_MODE_COUNT;
+}
+
+const char* powerModeName(PowerMode m) {
+  return m < POWER_MODE_COUNT ? modeNames[m] : "?";
+}
+
+void powerNoteReading() {
+  stats.readings++;
+  saveState(0);
+}
+
+void powerDeepSleep(uint32_t ms) {
+  uint64_t maxUs = ESP.deepSleepMax();
+  uint64_t us = (uint64_t)ms * 1000;
+  if (maxUs && us > maxUs) {
+    us = maxUs;
+    ms = (uint32_t)(us / 1000);
+  }
+  saveState(ms);
+
+  LOGI("POWER", "Deep sleep for %lu s", (unsigned long)(ms / 1000));
+  logFlush();
+  ESP.deepSleep(us);
+}
+
+const PowerStats& powerStats() {
+  accumulate();
+  return stats;
+}
+
+float powerAverageMa() {
+  const PowerStats& s = powerStats();
+  uint64_t ms = (uint64_t)s.busyMs + s.idleMs + s.deepMs;
+  return ms ? (float)s.chargeUAms / ms / 1000.0f : 0.0f;
+}
+
+float powerChargePerReadingMas() {
+  const PowerStats& s = powerStats();
+  return s.readings ? (float)s.chargeUAms / s.readings / 1e6f : 0.0f;
+}
+
+void powerPrintStats() {
+  float avgMa = powerAverageMa();
+  float perReading = powerChargePerReadingMas();
+
+  CONSOLE("\n[POWER] Charge MODEL (time in state x assumed POWER_UA_* currents):\n");
+  CONSOLE("  Mode: %s\n", modeNames[mode]);
+  CONSOLE("  Busy / idle / deep: %lu / %lu / %lu s (%lu deep-sleep cycles)\n",
+          (unsigned long)(stats.busyMs / 1000), (unsigned long)(stats.idleMs / 1000),
+          (unsigned long)(stats.deepMs / 1000), (unsigned long)stats.deepWakes);
+  CONSOLE("  Charge: %.3f mAh, average %.2f mA\n",
+          (float)stats.chargeUAms / 3.6e9f, avgMa);
+  CONSOLE("  Readings: %lu, %.1f mAs per reading\n",
+          (unsigned long)stats.readings, perReading);
+  if (avgMa > 0) {
+    CONSOLE("  Battery (%u mAh): ~%.0f h (model)\n", POWER_BATTERY_MAH, POWER_BATTERY_MAH / avgMa);
+  }
+  CONSOLE("  Not measured - the saving shown is the assumed currents; verify with a meter\n");
+}
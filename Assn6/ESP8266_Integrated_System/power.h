@@ -0,0 +1,97 @@
+// ============================================================================
+// power.h - Power Manager (Light Sleep, Deep-Sleep Duty Cycle, RTC State)
+// ============================================================================
+// Purpose: Let the node run from a battery
+// Modes:
+//   POWER_ACTIVE  radio always listening (lowest latency, previous behaviour)
+//   POWER_LIGHT   automatic light sleep allowed while the scheduler idles;
+//                 the radio wakes for DTIM beacons, Switch 1 (GPIO0) wakes
+//                 the CPU. GPIO16 cannot wake light sleep - Switch 2 is seen
+//                 on the next scheduled tick. The timer0 tick drops to
+//                 POWER_ADC_SAMPLE_HZ and the polled tasks are stretched
+//                 (main.cpp), but the tick still interrupts periodically,
+//                 so how often the SDK really sleeps is not known here.
+//   POWER_DEEP    sensor-only duty cycle: wake, log one reading, stay up
+//                 POWER_DEEP_GRACE_MS for a button press, deep sleep again.
+//                 Timer wake needs GPIO16 wired to RST, which clashes with
+//                 Switch 2 on GPIO16 (a press would reset the board), so the
+//                 mode is compiled out unless POWER_DEEP_ENABLE is set and
+//                 Switch 2 has been moved (config.h).
+// RTC state: Counters, event sequence, LED/RGB state, clock anchor and the
+//            charge accounting live in RTC user memory (CRC checked), so
+//            they survive deep sleep without flash writes.
+// Accounting: A MODEL, not a measurement - time in each state (scheduler
+//             busy / idle, deep sleep) times the assumed POWER_UA_* currents
+//             in config.h. Idle time outside active mode is billed at
+//             POWER_UA_IDLE_LIGHT as if the SDK light-slept through all of
+//             it, so the gain over active mode it shows is that assumption
+//             restated. It does not verify the battery gain: measure the
+//             current per reading with a meter for that.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+enum PowerMode : uint8_t {
+  POWER_ACTIVE = 0,
+  POWER_LIGHT,
+  POWER_DEEP,
+  POWER_MODE_COUNT
+};
+
+/**
+ * Charge accounting since the counters were last cleared
+ */
+struct PowerStats {
+  uint32_t busyMs;         // Awake, running tasks
+  uint32_t idleMs;         // Awake, sleeping in the scheduler
+  uint32_t deepMs;         // In deep sleep
+  uint64_t chargeUAms;     // Modelled charge (uA * ms)
+  uint32_t readings;       // Readings logged (powerNoteReading)
+  uint32_t deepWakes;      // Deep-sleep cycles completed
+};
+
+/**
+ * Restore RTC state (after switches, LEDs and events are initialized)
+ * and apply the stored power mode
+ */
+void powerBegin();
+
+/**
+ * Select a power mode (persisted in the KV store); unavailable modes
+ * are refused
+ */
+void powerSetMode(PowerMode mode);
+PowerMode powerMode();
+const char* powerModeName(PowerMode mode);
+
+/**
+ * False for POWER_DEEP unless it is enabled in config.h
+ */
+bool powerModeAvailable(PowerMode mode);
+
+/**
+ * Count one logged reading and checkpoint the RTC state
+ */
+void powerNoteReading();
+
+/**
+ * Save state and enter deep sleep (does not return)
+ */
+void powerDeepSleep(uint32_t ms);
+
+/**
+ * Get accounting counters (brought up to date first)
+ */
+const PowerStats& powerStats();
+
+/**
+ * Average current and charge per logged reading
+ */
+float powerAverageMa();
+float powerChargePerReadingMas();
+
+/**
+ * Print mode, modelled charge and battery life to Serial
+ */
+void powerPrintStats();
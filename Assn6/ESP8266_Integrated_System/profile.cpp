@@ -0,0 +1,50 @@
+// ============================================================================
+// profile.cpp - Latency Histogram Registry
+// ============================================================================
+
+#include "profile.h"
+#include "config.h"
+#include "logger.h"
+
+uint8_t profileCyclesPerUs = 80;
+
+struct ProfileEntry {
+  LatencyHistogram* hist;
+  const char* name;
+};
+
+static ProfileEntry entries[PROFILE_MAX_HISTOGRAMS];
+static uint8_t entryCount = 0;
+static uint32_t windowStart = 0;
+
+void profileBegin() {
+  profileCyclesPerUs = ESP.getCpuFreqMHz();
+  windowStart = millis();
+}
+
+bool profileRegister(LatencyHistogram& h, const char* name) {
+  for (uint8_t i = 0; i < entryCount; i++) {
+    if (entries[i].hist == &h) return true;
+  }
+  if (entryCount >= PROFILE_MAX_HISTOGRAMS) return false;
+  h.reset();
+  entries[entryCount++] = {&h, name};
+  return true;
+}
+
+void profilePrintAndReset() {
+  uint32_t now = millis();
+  CONSOLE("\n[PROFILE] Latency over the last %lu s (us):\n",
+          (unsigned long)((now - windowStart) / 1000));
+  CONSOLE("  Name              Count      p50      p90      p99      max\n");
+
+  for (uint8_t i = 0; i < entryCount; i++) {
+    LatencyHistogram& h = *entries[i].hist;
+    CONSOLE("  %-14s %8lu %8lu %8lu %8lu %8lu\n",
+            entries[i].name, (unsigned long)h.samples(),
+            (unsigned long)h.percentile(50), (unsigned long)h.percentile(90),
+            (unsigned long)h.percentile(99), (unsigned long)h.max());
+    h.reset();
+  }
+  windowStart = now;
+}
@@ -0,0 +1,134 @@
+// ============================================================================
+// profile.h - Latency Histograms and Stage Profiler
+// ============================================================================
+// Purpose: Always-on timing of the loop, each scheduler task and each button
+//          pipeline stage, dumped over serial ('P') as p50/p90/p99/max
+// Method: Fixed-bucket log-linear histogram (HDR style): exact below 4 us,
+//         then 4 sub-buckets per power of two up to 2^26 us (~67 s), so any
+//         value is binned within 25% with 100 16-bit counters (200 bytes).
+//         Timing uses ESP.getCycleCount() (one instruction).
+// Cost: One cycle-count read, a divide and a count-leading-zeros per sample
+// Note: The cycle counter wraps after ~53 s at 80 MHz - longer spans alias
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+/**
+ * CPU cycles per microsecond (set by profileBegin())
+ */
+extern uint8_t profileCyclesPerUs;
+
+class LatencyHistogram {
+ public:
+  static const uint8_t SUB_BITS = 2;
+  static const uint8_t SUBS = 1 << SUB_BITS;
+  static const uint8_t MAX_LOG2 = 25;
+  static const uint8_t BUCKETS = SUBS + (MAX_LOG2 - SUB_BITS + 1) * SUBS;
+
+  /**
+   * Record one duration in microseconds
+   */
+  void record(uint32_t us) {
+    if (us > max_) max_ = us;
+    samples_++;
+    uint8_t b = bucketOf(us);
+    if (++counts_[b] == 0xFFFF) halve();
+    total_++;
+  }
+
+  void recordCycles(uint32_t cycles) {
+    record(cycles / profileCyclesPerUs);
+  }
+
+  /**
+   * Value at or below which p percent of samples fall (bucket upper bound)
+   */
+  uint32_t percentile(uint8_t p) const {
+    if (total_ == 0) return 0;
+    uint32_t rank = ((uint64_t)total_ * p + 99) / 100;
+    if (rank == 0) rank = 1;
+    uint32_t seen = 0;
+    for (uint8_t b = 0; b < BUCKETS; b++) {
+      seen += counts_[b];
+      if (seen >= rank) {
+        uint32_t upper = bucketUpper(b);
+        return upper < max_ ? upper : max_;
+      }
+    }
+    return max_;
+  }
+
+  uint32_t max() const { return max_; }
+  uint32_t samples() const { return samples_; }
+
+  void reset() {
+    memset(counts_, 0, sizeof(counts_));
+    total_ = 0;
+    samples_ = 0;
+    max_ = 0;
+  }
+
+  static uint8_t bucketOf(uint32_t v) {
+    if (v < SUBS) return v;
+    const uint32_t top = (1UL << (MAX_LOG2 + 1)) - 1;
+    if (v > top) v = top;
+    uint8_t k = 31 - __builtin_clz(v);
+    return SUBS + (k - SUB_BITS) * SUBS + ((v >> (k - SUB_BITS)) & (SUBS - 1));
+  }
+
+  static uint32_t bucketUpper(uint8_t b) {
+    if (b < SUBS) return b;
+    uint8_t shift = (b - SUBS) / SUBS;       // k - SUB_BITS
+    uint8_t sub = (b - SUBS) % SUBS;
+    return ((uint32_t)(SUBS + sub + 1) << shift) - 1;
+  }
+
+ private:
+  // Keep the shape when a bucket saturates; totals are rescaled with it
+  void halve() {
+    total_ = 0;
+    for (uint8_t b = 0; b < BUCKETS; b++) {
+      counts_[b] >>= 1;
+      total_ += counts_[b];
+    }
+  }
+
+  uint16_t counts_[BUCKETS];
+  uint32_t total_;         // Sum of counts_ (rescaled by halve())
+  uint32_t samples_;       // Samples recorded since reset
+  uint32_t max_;
+};
+
+/**
+ * Wall time of consecutive pipeline stages (survives coroutine suspension)
+ */
+struct StageTimer {
+  uint32_t start;
+
+  void begin() { start = ESP.getCycleCount(); }
+
+  /**
+   * Record the stage that just finished and start the next one
+   */
+  void lap(LatencyHistogram& h) {
+    uint32_t now = ESP.getCycleCount();
+    h.recordCycles(now - start);
+    start = now;
+  }
+};
+
+/**
+ * Read the CPU clock for cycle conversion
+ */
+void profileBegin();
+
+/**
+ * Add a histogram to the 'P' dump (PROFILE_MAX_HISTOGRAMS)
+ */
+bool profileRegister(LatencyHistogram& h, const char* name);
+
+/**
+ * Print p50/p90/p99/max of every registered histogram, then reset them
+ */
+void profilePrintAndReset();
@@ -0,0 +1,88 @@
+// ============================================================================
+// pt.h - Stackless Coroutines (Protothreads)
+// ============================================================================
+// Purpose: Write multi-step workflows sequentially while letting them suspend
+//          at every wait, so several can run interleaved from one task
+// Method: Duff's device - the resume point is the source line stored in the
+//         Pt and a switch() jumps back to it on the next call
+// Features: Fixed-size state (Pt + the caller's own struct), no heap, no
+//           per-coroutine stack
+// Rules (inside PT_BEGIN .. PT_END):
+//   - Locals do not survive a wait - keep them in the pipeline's state struct
+//   - No switch() statements (the coroutine body already is one)
+//   - A blocking call (e.g. an HTTPS POST) still blocks; waits go between them
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+/**
+ * Result of running a coroutine once
+ */
+enum PtState : uint8_t {
+  PT_WAITING = 0,   // Suspended on a condition or sleep
+  PT_YIELDED,       // Suspended voluntarily, has more work
+  PT_ENDED          // Finished (or exited), next call starts over
+};
+
+/**
+ * Coroutine context - resume point plus a deadline for sleeps/timeouts
+ */
+struct Pt {
+  uint16_t lc;
+  uint32_t deadline;
+};
+
+#define PT_INIT(pt)  do { (pt)->lc = 0; } while (0)
+
+#define PT_BEGIN(pt) switch ((pt)->lc) { case 0:
+
+#define PT_END(pt)   } (pt)->lc = 0; return PT_ENDED
+
+/**
+ * Suspend until cond is true (re-evaluated on every call)
+ */
+#define PT_WAIT_UNTIL(pt, cond)                  \
+  do {                                           \
+    (pt)->lc = __LINE__; case __LINE__:          \
+    if (!(cond)) return PT_WAITING;              \
+  } while (0)
+
+/**
+ * Give other coroutines a turn, resume on the next call
+ */
+#define PT_YIELD(pt)                             \
+  do {                                           \
+    (pt)->lc = __LINE__;                         \
+    return PT_YIELDED;                           \
+    case __LINE__:;                              \
+  } while (0)
+
+/**
+ * Start the deadline used by PT_SLEEP / PT_WAIT_TIMEOUT
+ */
+#define PT_TIMER_SET(pt, ms)  do { (pt)->deadline = millis() + (ms); } while (0)
+#define PT_TIMER_EXPIRED(pt)  ((int32_t)(millis() - (pt)->deadline) >= 0)
+
+/**
+ * Suspend for ms milliseconds
+ */
+#define PT_SLEEP(pt, ms)                         \
+  do {                                           \
+    PT_TIMER_SET(pt, ms);                        \
+    PT_WAIT_UNTIL(pt, PT_TIMER_EXPIRED(pt));     \
+  } while (0)
+
+/**
+ * Suspend until cond is true or ms elapse; check cond afterwards to tell
+ */
+#define PT_WAIT_TIMEOUT(pt, cond, ms)                       \
+  do {                                                      \
+    PT_TIMER_SET(pt, ms);                                   \
+    PT_WAIT_UNTIL(pt, (cond) || PT_TIMER_EXPIRED(pt));      \
+  } while (0)
+
+/**
+ * Finish now; the next call starts from PT_BEGIN
+ */
+#define PT_EXIT(pt)  do { (pt)->lc = 0; return PT_ENDED; } while (0)
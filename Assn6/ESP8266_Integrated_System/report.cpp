@@ -0,0 +1,101 @@
+// ============================================================================
+// report.cpp - Report-by-Exception (Deadband) Engine Implementation
+// ============================================================================
+
+#include "report.h"
+#include "config.h"
+#include "logger.h"
+
+// Indexed by SensorChannel
+static Deadband deadbands[CH_COUNT] = {
+  {DEADBAND_TEMP_C,     0.0f},              // CH_TEMPERATURE
+  {DEADBAND_HUMIDITY,   0.0f},              // CH_HUMIDITY
+  {DEADBAND_LUX,        DEADBAND_LUX_REL}   // CH_LUX
+};
+static_assert(sizeof(deadbands) / sizeof(deadbands[0]) == CH_COUNT,
+              "One deadband per sensor channel");
+
+static float lastValue[CH_COUNT];
+static uint32_t lastMask = 0;            // Channels reported at least once
+static uint32_t lastReportAt = 0;
+static bool reportedOnce = false;
+
+static ReportChannelStats chStats[CH_COUNT];
+static uint32_t decisions = 0;
+static uint32_t suppressed = 0;
+static uint32_t heartbeats = 0;
+
+/**
+ * True if value moved outside the channel's deadband
+ */
+static bool outsideDeadband(uint8_t ch, float value) {
+  if (!(lastMask & (1UL << ch))) return true;   // Never reported
+  float band = deadbands[ch].absolute;
+  float rel = deadbands[ch].relative * fabsf(lastValue[ch]);
+  if (rel > band) band = rel;
+  return fabsf(value - lastValue[ch]) > band;
+}
+
+bool reportDue(const float* values, uint32_t validMask) {
+  bool changed = false;
+  for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+    if (!(validMask & (1UL << ch)) || isnan(values[ch])) continue;
+    chStats[ch].evaluated++;
+    if (outsideDeadband(ch, values[ch])) {
+      chStats[ch].changed++;
+      changed = true;
+    }
+  }
+
+  decisions++;
+  if (changed) return true;
+
+  if (!reportedOnce || millis() - lastReportAt >= REPORT_HEARTBEAT_MS) {
+    heartbeats++;
+    return true;
+  }
+
+  suppressed++;
+  return false;
+}
+
+void reportSent(const float* values, uint32_t validMask) {
+  for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+    if (!(validMask & (1UL << ch)) || isnan(values[ch])) continue;
+    lastValue[ch] = values[ch];
+    lastMask |= (1UL << ch);
+  }
+  lastReportAt = millis();
+  reportedOnce = true;
+}
+
+void reportSetDeadband(SensorChannel ch, const Deadband& db) {
+  if (ch < CH_COUNT) deadbands[ch] = db;
+}
+
+const ReportChannelStats& reportStats(SensorChannel ch) {
+  return chStats[ch < CH_COUNT ? ch : 0];
+}
+
+void reportPrintStats() {
+  CONSOLE("\n[REPORT] Report-by-exception statistics:\n");
+  CONSOLE("  Uploads:    %lu of %lu (%lu heartbeat)\n", (unsigned long)(decisions - suppressed),
+          (unsigned long)decisions, (unsigned long)heartbeats);
+  if (decisions) {
+    CONSOLE("  Suppressed: %.1f%%\n", 100.0f * suppressed / decisions);
+  }
+  for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+    const ChannelInfo& ci = channelInfo((SensorChannel)ch);
+    CONSOLE("  %s: +/-%.1f %s", ci.name, deadbands[ch].absolute, ci.unit);
+    if (deadbands[ch].relative > 0) {
+      CONSOLE(" or %.0f%%", deadbands[ch].relative * 100.0f);
+    }
+    CONSOLE(", %lu/%lu changed", (unsigned long)chStats[ch].changed,
+            (unsigned long)chStats[ch].evaluated);
+    if (chStats[ch].evaluated) {
+      CONSOLE(" (%.1f%% suppressed)", 100.0f * (chStats[ch].evaluated - chStats[ch].changed) /
+                                      chStats[ch].evaluated);
+    }
+    CONSOLE("\n");
+  }
+}
@@ -0,0 +1,58 @@
+// ============================================================================
+// report.h - Report-by-Exception (Deadband) Engine
+// ============================================================================
+// Purpose: Decide whether a periodic upload carries new information
+// Method: Per-channel absolute and relative deadbands around the last
+//         reported value, plus a maximum silence interval (heartbeat)
+// Replaces: FNV hash of the whole payload in tx.cpp (never matched, since
+//           the timestamp and activity count are part of the payload)
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include "sensors.h"
+
+/**
+ * Deadband of one channel. A value is reported when it moved more than
+ * max(absolute, relative * |last reported|) since the last report.
+ */
+struct Deadband {
+  float absolute;       // Channel units
+  float relative;       // Fraction of the last reported value (0 = off)
+};
+
+/**
+ * Per-channel suppression counters
+ */
+struct ReportChannelStats {
+  uint32_t evaluated;   // Valid values offered
+  uint32_t changed;     // Values outside the deadband
+};
+
+/**
+ * Check a set of channel values against the deadbands
+ * @param values   One value per channel (indexed by SensorChannel)
+ * @param validMask Bit n set = values[n] present
+ * @return true if any channel moved or the heartbeat is due
+ */
+bool reportDue(const float* values, uint32_t validMask);
+
+/**
+ * Record values as reported (call after a successful upload)
+ */
+void reportSent(const float* values, uint32_t validMask);
+
+/**
+ * Override a channel's deadband at runtime
+ */
+void reportSetDeadband(SensorChannel ch, const Deadband& db);
+
+/**
+ * Get counters for one channel
+ */
+const ReportChannelStats& reportStats(SensorChannel ch);
+
+/**
+ * Print suppression ratios to Serial
+ */
+void reportPrintStats();
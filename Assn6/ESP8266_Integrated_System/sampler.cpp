@@ -0,0 +1,179 @@
+// ============================================================================
+// sampler.cpp - Background Sensor Sampler Implementation
+// ============================================================================
+
+#include "sampler.h"
+#include "config.h"
+#include "logger.h"
+
+struct DriverState {
+  uint32_t lastStart;
+  uint32_t consecutiveFailures;
+  bool started;
+  bool busy;
+  bool refreshRequested;
+};
+
+static DriverState state[SENSOR_MAX_DRIVERS];
+static SensorReading cached;
+static SamplerStats stats = {0, 0, 0, 0};
+
+static SampleListener listeners[SAMPLER_MAX_LISTENERS];
+static uint8_t listenerCount = 0;
+
+/**
+ * Store a finished sample into the cache
+ */
+static void storeSample(const SensorDriver* d, const float* values) {
+  uint32_t now = millis();
+  for (uint8_t c = 0; c < d->channelCount; c++) {
+    SensorChannel ch = d->channels[c];
+    cached.value[ch] = values[c];
+    cached.sampledAt[ch] = now;
+    cached.validMask |= (1UL << ch);
+    for (uint8_t l = 0; l < listenerCount; l++) {
+      listeners[l](ch, values[c], now);
+    }
+  }
+}
+
+/**
+ * Poll one driver: start a due sample, then collect a running one
+ */
+static void pollDriver(uint8_t i) {
+  const SensorDriver* d = sensorDriver(i);
+  DriverState& st = state[i];
+  uint32_t now = millis();
+
+  if (!st.busy) {
+    uint32_t sinceStart = now - st.lastStart;
+    if (st.started && sinceStart < d->minIntervalMs) return;
+    if (st.started && !st.refreshRequested && sinceStart < d->intervalMs) return;
+    if (!d->start()) return;
+
+    st.lastStart = now;
+    st.started = true;
+    st.busy = true;
+    st.refreshRequested = false;
+  }
+
+  // Synchronous drivers complete on the first poll
+  float values[CH_COUNT];
+  SensorPollResult r = d->poll(values);
+  if (r == SENSOR_BUSY) return;
+  st.busy = false;
+
+  if (r == SENSOR_SKIP) return;
+
+  if (r == SENSOR_OK) {
+    storeSample(d, values);
+    stats.samples++;
+    st.consecutiveFailures = 0;
+  } else {
+    // Keep serving the last good value
+    stats.failures++;
+    st.consecutiveFailures++;
+    if (st.consecutiveFailures == SAMPLE_FAIL_WARN) {
+      LOGW("SAMPLER", "%u consecutive failures on %s", SAMPLE_FAIL_WARN, d->name);
+    }
+  }
+}
+
+void samplerBegin() {
+  memset(state, 0, sizeof(state));
+  memset(&cached, 0, sizeof(cached));
+  for (uint8_t ch = 0; ch < CH_COUNT; ch++) cached.value[ch] = NAN;
+
+  for (uint8_t i = 0; i < sensorDriverCount(); i++) {
+    state[i].refreshRequested = true;
+    LOGI("SAMPLER", "%s every %lu ms", sensorDriver(i)->name,
+         (unsigned long)sensorDriver(i)->intervalMs);
+  }
+}
+
+void samplerPoll() {
+  uint32_t worst = 0;
+  for (uint8_t i = 0; i < sensorDriverCount(); i++) {
+    pollDriver(i);
+    worst = max(worst, state[i].consecutiveFailures);
+  }
+  stats.consecutiveFailures = worst;
+}
+
+bool samplerGet(SensorReading& out, uint32_t* ageMs) {
+  out = cached;
+  uint32_t now = millis();
+  uint32_t oldest = 0;
+
+  for (uint8_t i = 0; i < sensorDriverCount(); i++) {
+    const SensorDriver* d = sensorDriver(i);
+    bool stale = false;
+    for (uint8_t c = 0; c < d->channelCount; c++) {
+      SensorChannel ch = d->channels[c];
+      if (!out.has(ch)) {
+        stale = true;
+        continue;
+      }
+      uint32_t age = now - out.sampledAt[ch];
+      if (age > SAMPLE_STALE_MS) {
+        stale = true;
+        stats.staleServed++;
+      }
+      if (age > SAMPLE_MAX_AGE_MS) {
+        out.validMask &= ~(1UL << ch);
+      } else {
+        oldest = max(oldest, age);
+      }
+    }
+    if (stale) state[i].refreshRequested = true;
+  }
+
+  if (ageMs) *ageMs = oldest;
+  return out.validMask != 0;
+}
+
+bool samplerFresh(uint32_t maxAgeMs) {
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < sensorDriverCount(); i++) {
+    const SensorDriver* d = sensorDriver(i);
+    for (uint8_t c = 0; c < d->channelCount; c++) {
+      SensorChannel ch = d->channels[c];
+      if (!cached.has(ch) || now - cached.sampledAt[ch] > maxAgeMs) return false;
+    }
+  }
+  return true;
+}
+
+bool samplerAddListener(SampleListener listener) {
+  if (listenerCount >= SAMPLER_MAX_LISTENERS) return false;
+  listeners[listenerCount++] = listener;
+  return true;
+}
+
+void samplerRequestRefresh() {
+  for (uint8_t i = 0; i < sensorDriverCount(); i++) {
+    state[i].refreshRequested = true;
+  }
+}
+
+const SamplerStats& samplerStats() {
+  return stats;
+}
+
+void samplerPrintStats() {
+  uint32_t now = millis();
+  CONSOLE("\n[SAMPLER] Statistics:\n");
+  CONSOLE("  Samples:   %lu\n", (unsigned long)stats.samples);
+  CONSOLE("  Failures:  %lu (worst streak %lu)\n",
+          (unsigned long)stats.failures, (unsigned long)stats.consecutiveFailures);
+  CONSOLE("  Stale:     %lu\n", (unsigned long)stats.staleServed);
+  for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+    const ChannelInfo& ci = channelInfo((SensorChannel)ch);
+    if (cached.has((SensorChannel)ch)) {
+      CONSOLE("  %s: %.1f %s (%lu ms old)\n", ci.name, cached.value[ch], ci.unit,
+              (unsigned long)(now - cached.sampledAt[ch]));
+    } else {
+      CONSOLE("  %s: no sample yet\n", ci.name);
+    }
+  }
+}
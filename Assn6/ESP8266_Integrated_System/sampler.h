@@ -0,0 +1,76 @@
+// ============================================================================
+// sampler.h - Background Sensor Sampler
+// ============================================================================
+// Purpose: Sample every registered sensor driver on its own schedule and
+//          cache the last good value of every channel
+// Features: Stale-while-revalidate reads, per-driver minimum interval
+//           enforcement, transient read failures never invalidate the cache
+// Consumers: Button 1 logging, messaging, local rules
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include "sensors.h"
+
+/**
+ * Sampler counters (summed over all drivers)
+ */
+struct SamplerStats {
+  uint32_t samples;             // Successful reads
+  uint32_t failures;            // Failed reads (cache kept)
+  uint32_t consecutiveFailures; // Worst current failure streak of any driver
+  uint32_t staleServed;         // Reads answered from a stale cache
+};
+
+/**
+ * Called once per fresh channel value (loop context)
+ */
+typedef void (*SampleListener)(SensorChannel ch, float value, uint32_t sampledAt);
+
+/**
+ * Start the sampler and kick off the first read of every driver
+ */
+void samplerBegin();
+
+/**
+ * Drive the schedules and collect finished reads (call every loop iteration)
+ */
+void samplerPoll();
+
+/**
+ * Get the latest valid reading (memory read, never waits for a sensor).
+ * Channels older than SAMPLE_STALE_MS trigger a background refresh of
+ * their driver and are still returned; channels older than
+ * SAMPLE_MAX_AGE_MS are cleared from validMask.
+ * @param out Receives the cached reading
+ * @param ageMs Optional, receives the age of the oldest valid channel
+ * @return true if at least one channel is valid
+ */
+bool samplerGet(SensorReading& out, uint32_t* ageMs = nullptr);
+
+/**
+ * Subscribe to fresh samples (aggregation, anomaly detection, ...)
+ * @return false if SAMPLER_MAX_LISTENERS is reached
+ */
+bool samplerAddListener(SampleListener listener);
+
+/**
+ * Check that every channel has a valid sample no older than maxAgeMs
+ * (no side effects - safe to poll while waiting for a refresh)
+ */
+bool samplerFresh(uint32_t maxAgeMs);
+
+/**
+ * Request a read of every driver as soon as its minimum interval allows
+ */
+void samplerRequestRefresh();
+
+/**
+ * Get sampler counters
+ */
+const SamplerStats& samplerStats();
+
+/**
+ * Print sampler counters and cache ages to Serial
+ */
+void samplerPrintStats();
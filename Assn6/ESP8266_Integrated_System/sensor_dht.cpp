@@ -0,0 +1,57 @@
+// ============================================================================
+// sensor_dht.cpp
+// ============================================================================
+// Purpose: Registry adapter for the DHT11 (temperature + humidity)
+// Driver: dht_async (interrupt-driven, interrupts stay enabled during reads)
+// Hardware: DHT11 on GPIO14
+// ============================================================================
+
+#include "sensors.h"
+#include "config.h"
+#include "logger.h"
+#include "dht_async.h"
+
+static const SensorChannel dhtChannels[] = {CH_TEMPERATURE, CH_HUMIDITY};
+
+static bool dhtDriverBegin() {
+  dhtBegin(PIN_DHT, DHTTYPE);
+  return true;
+}
+
+static bool dhtDriverStart() {
+  return dhtStartRead();
+}
+
+static SensorPollResult dhtDriverPoll(float* values) {
+  DhtResult r;
+  DhtStatus st = dhtPoll(&r);
+  if (st == DHT_BUSY) return SENSOR_BUSY;
+  if (st != DHT_OK || isnan(r.temperatureC) || isnan(r.humidity)) return SENSOR_FAIL;
+  values[0] = r.temperatureC;
+  values[1] = r.humidity;
+  return SENSOR_OK;
+}
+
+static void dhtDriverPrintStats() {
+  const DhtStats& st = dhtStats();
+  CONSOLE("\n[DHT] Driver statistics:\n");
+  CONSOLE("  Reads:     %lu\n", (unsigned long)st.reads);
+  CONSOLE("  OK:        %lu\n", (unsigned long)st.ok);
+  CONSOLE("  Timeouts:  %lu\n", (unsigned long)st.timeouts);
+  CONSOLE("  Timing:    %lu\n", (unsigned long)st.timingErrors);
+  CONSOLE("  Checksum:  %lu\n", (unsigned long)st.checksumErrors);
+  CONSOLE("  Frame:     %lu us\n", (unsigned long)st.lastFrameUs);
+}
+
+extern const SensorDriver dhtSensorDriver = {
+  "DHT11",
+  dhtChannels,
+  sizeof(dhtChannels) / sizeof(dhtChannels[0]),
+  SAMPLE_INTERVAL_MS,
+  DHT_MIN_INTERVAL_MS,
+  50,                     // Edge ISRs + decode; the transfer itself is async
+  dhtDriverBegin,
+  dhtDriverStart,
+  dhtDriverPoll,
+  dhtDriverPrintStats
+};
@@ -0,0 +1,96 @@
+// ============================================================================
+// sensor_light.cpp
+// ============================================================================
+// Purpose: Registry driver for the HW-486 light sensor (ported from Assn3)
+// Hardware: HW-486 on A0 (INVERTED: lower ADC = brighter light)
+// Calibration: Multi-point table generated at compile time (lux_calib.h);
+//              seeded from the Assn3 linear fit until measured (config.h)
+// Acquisition: A0 sampled at ADC_SAMPLE_HZ from the timer0 interrupt
+//              (adc_acquire); each poll drains the sample ring
+// Filtering: Integer pipeline per sample:
+//            median-of-3 spike rejection -> 4x decimation -> moving average
+// ============================================================================
+
+#include "sensors.h"
+#include "config.h"
+#include "logger.h"
+#include "filters.h"
+#include "adc_acquire.h"
+#include "lux_calib.h"
+
+// Filter chain (window sizes fixed at compile time)
+static const uint16_t OVERSAMPLE_COUNT = 4;
+static const uint16_t FILTER_SIZE = 8;
+
+static MedianFilter<3> spikeFilter;
+static Oversampler<OVERSAMPLE_COUNT> decimator;
+static MovingAverage<FILTER_SIZE> average;
+
+// The averaged ADC value has Oversampler FRACTION_BITS extra bits
+static const uint8_t ADC_FRAC = Oversampler<OVERSAMPLE_COUNT>::FRACTION_BITS;
+static const int32_t LUX_MAX = 5000;   // Allow up to 5000 lux
+
+static const SensorChannel lightChannels[] = {CH_LUX};
+
+/**
+ * Convert a fixed-point ADC value to calibrated lux (table lookup)
+ */
+static int32_t adcToLux(int32_t adcQ) {
+  int32_t lux = luxFromAdcQ(adcQ, ADC_FRAC);
+  return constrain(lux, (int32_t)0, LUX_MAX);
+}
+
+static bool lightDriverBegin() {
+  spikeFilter.reset();
+  decimator.reset();
+  average.reset();
+  adcAcqBegin(ADC_SAMPLE_HZ);
+#if !LUX_CAL_MEASURED
+  LOGW("LIGHT", "Lux table is a placeholder (linear fit) - see LUX_CAL_MEASURED");
+#endif
+  return true;
+}
+
+static bool lightDriverStart() {
+  return true;   // Samples are already queued by the timer ISR
+}
+
+static SensorPollResult lightDriverPoll(float* values) {
+  bool updated = false;
+  uint16_t sample;
+
+  while (adcAcqRead(sample)) {
+    int32_t raw = spikeFilter.push(sample);
+    if (decimator.push(raw)) {
+      average.push(decimator.value());
+      updated = true;
+    }
+  }
+
+  if (!updated) return SENSOR_SKIP;
+  values[0] = (float)adcToLux(average.value());
+  return SENSOR_OK;
+}
+
+static void lightDriverPrintStats() {
+  const AdcAcqStats& st = adcAcqStats();
+  CONSOLE("\n[ADC] Acquisition statistics:\n");
+  CONSOLE("  Rate:      %u Hz\n", st.rateHz);
+  CONSOLE("  Samples:   %lu\n", (unsigned long)st.samples);
+  CONSOLE("  Dropped:   %lu\n", (unsigned long)st.dropped);
+  CONSOLE("  Skipped:   %lu ticks (flash access)\n", (unsigned long)st.skipped);
+  CONSOLE("  Ring peak: %u/%u\n", st.highWater, ADC_RING_SIZE - 1);
+}
+
+extern const SensorDriver lightSensorDriver = {
+  "HW-486 Light",
+  lightChannels,
+  sizeof(lightChannels) / sizeof(lightChannels[0]),
+  LIGHT_INTERVAL_MS,
+  0,
+  40,                     // Per drained sample: a few integer ops
+  lightDriverBegin,
+  lightDriverStart,
+  lightDriverPoll,
+  lightDriverPrintStats
+};
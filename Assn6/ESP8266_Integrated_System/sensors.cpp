@@ -1,38 +1,72 @@
 // ============================================================================
 // sensors.cpp
 // ============================================================================
-// Purpose: DHT11 sensor driver implementation
-// Library: Adafruit DHT sensor library
-// Output: Temperature (Celsius) and relative humidity (percentage)
-// Error handling: NaN detection and error reporting
+// Purpose: Sensor registry implementation
+// Contains: Channel metadata table and the list of active drivers
 // ============================================================================
 
 #include "sensors.h"
 #include "config.h"
-#include <DHT.h>
+#include "logger.h"
 
-static DHT dht(PIN_DHT, DHTTYPE);
+// Drivers (one file each)
+extern const SensorDriver dhtSensorDriver;
+extern const SensorDriver lightSensorDriver;
+
+static const SensorDriver* const drivers[] = {
+  &dhtSensorDriver,
+  &lightSensorDriver,
+};
+
+static const uint8_t DRIVER_COUNT = sizeof(drivers) / sizeof(drivers[0]);
+static_assert(sizeof(drivers) / sizeof(drivers[0]) <= SENSOR_MAX_DRIVERS,
+              "Increase SENSOR_MAX_DRIVERS in config.h");
+
+static const ChannelInfo channelTable[CH_COUNT] = {
+  {"Temperature", "°C",  "temperature_C"},
+  {"Humidity",    "%",   "humidity_pct"},
+  {"Light",       "lux", "lux"},
+};
 
 bool sensorsBegin() {
-  dht.begin();
-  Serial.println("[SENSORS] DHT11 initialized");
-  return true;
+  bool ok = true;
+  for (uint8_t i = 0; i < DRIVER_COUNT; i++) {
+    bool drvOk = drivers[i]->begin();
+    if (drvOk) {
+      LOGI("SENSORS", "%s initialized", drivers[i]->name);
+    } else {
+      LOGE("SENSORS", "%s FAILED to initialize", drivers[i]->name);
+    }
+    ok = ok && drvOk;
+  }
+  return ok;
+}
+
+uint8_t sensorDriverCount() {
+  return DRIVER_COUNT;
 }
 
-bool readDHT(float& tC, float& h) {
-  h = dht.readHumidity();
-  tC = dht.readTemperature();
-  
-  if (isnan(h) || isnan(tC)) {
-    Serial.println("[DHT] Error: Read failed (sensor not responding or NaN)");
-    return false;
+const SensorDriver* sensorDriver(uint8_t index) {
+  return (index < DRIVER_COUNT) ? drivers[index] : nullptr;
+}
+
+const ChannelInfo& channelInfo(SensorChannel ch) {
+  return channelTable[ch < CH_COUNT ? ch : 0];
+}
+
+void sensorsPrintStats() {
+  CONSOLE("\n[SENSORS] Registered drivers:\n");
+  for (uint8_t i = 0; i < DRIVER_COUNT; i++) {
+    const SensorDriver* d = drivers[i];
+    CONSOLE("  %s: every %lu ms, ~%u us/sample, channels:",
+            d->name, (unsigned long)d->intervalMs, d->costUs);
+    for (uint8_t c = 0; c < d->channelCount; c++) {
+      const ChannelInfo& ci = channelInfo(d->channels[c]);
+      CONSOLE(" %s [%s]", ci.name, ci.unit);
+    }
+    CONSOLE("\n");
+  }
+  for (uint8_t i = 0; i < DRIVER_COUNT; i++) {
+    if (drivers[i]->printStats) drivers[i]->printStats();
   }
-  
-  Serial.print("[DHT] T=");
-  Serial.print(tC);
-  Serial.print("°C, H=");
-  Serial.print(h);
-  Serial.println("%");
-  
-  return true;
 }
@@ -1,13 +1,86 @@
 // ============================================================================
 // sensors.h
 // ============================================================================
-// Purpose: DHT11 temperature/humidity sensor interface declarations
-// Functions: Sensor initialization and data reading
-// Hardware: DHT11 on GPIO14
+// Purpose: Sensor registry - channel definitions, driver interface and the
+//          typed reading record shared by sampler, uploader and messaging
+// Drivers: sensor_dht.cpp (DHT11 on GPIO14), sensor_light.cpp (HW-486 on A0)
+// Adding a sensor: add its channels to SensorChannel/channelTable, write a
+//          SensorDriver and list it in the driver table in sensors.cpp
 // ============================================================================
 
 #pragma once
 #include <Arduino.h>
 
+/**
+ * Every measured quantity in the system
+ */
+enum SensorChannel : uint8_t {
+  CH_TEMPERATURE = 0,   // °C
+  CH_HUMIDITY,          // %RH
+  CH_LUX,               // lux
+  CH_COUNT
+};
+
+/**
+ * Channel metadata
+ */
+struct ChannelInfo {
+  const char* name;     // Human readable name
+  const char* unit;     // Display unit
+  const char* jsonKey;  // Field name in the upload payload
+};
+
+/**
+ * Result of a driver poll
+ */
+enum SensorPollResult : uint8_t {
+  SENSOR_BUSY = 0,      // Sample still in progress
+  SENSOR_OK,            // values[] filled
+  SENSOR_FAIL,          // Sample failed
+  SENSOR_SKIP           // Sample consumed by a filter, no new output yet
+};
+
+/**
+ * Driver descriptor. Drivers fill values[] in the order of channels[].
+ */
+struct SensorDriver {
+  const char* name;
+  const SensorChannel* channels;
+  uint8_t channelCount;
+  uint32_t intervalMs;      // Scheduled sampling period
+  uint32_t minIntervalMs;   // Hardware limit between samples
+  uint16_t costUs;          // Approximate CPU time per sample
+  bool (*begin)();
+  bool (*start)();          // Begin a sample; false if busy
+  SensorPollResult (*poll)(float* values);
+  void (*printStats)();     // Optional, may be nullptr
+};
+
+/**
+ * One typed reading covering all channels
+ */
+struct SensorReading {
+  float value[CH_COUNT];
+  uint32_t sampledAt[CH_COUNT];   // millis() per channel
+  uint32_t validMask;             // Bit n set = channel n valid
+
+  bool has(SensorChannel ch) const { return validMask & (1UL << ch); }
+  float get(SensorChannel ch) const { return has(ch) ? value[ch] : NAN; }
+};
+
+/**
+ * Initialize all registered drivers
+ */
 bool sensorsBegin();
-bool readDHT(float& tC, float& h);
\ No newline at end of file
+
+/**
+ * Registry access
+ */
+uint8_t sensorDriverCount();
+const SensorDriver* sensorDriver(uint8_t index);
+const ChannelInfo& channelInfo(SensorChannel ch);
+
+/**
+ * Print registered drivers and their statistics
+ */
+void sensorsPrintStats();
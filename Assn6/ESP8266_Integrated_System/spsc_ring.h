@@ -0,0 +1,71 @@
+// ============================================================================
+// spsc_ring.h - Lock-Free Single-Producer/Single-Consumer Ring Buffer
+// ============================================================================
+// Purpose: Pass data from an ISR (producer) to loop() (consumer) without
+//          disabling interrupts
+// Rules: Exactly one producer and one consumer. The producer only writes
+//        head_, the consumer only writes tail_. N must be a power of two;
+//        one slot is kept free to tell "full" from "empty".
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+template <typename T, uint16_t N>
+class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "Ring size must be a power of two");
+
+ public:
+  /**
+   * Producer side (ISR safe). Returns false if the ring is full.
+   */
+  bool IRAM_ATTR push(const T& item) {
+    uint16_t head = head_;
+    uint16_t next = (head + 1) & (N - 1);
+    if (next == tail_) return false;
+    buf_[head] = item;
+    barrier();                  // Data must land before the index moves
+    head_ = next;
+    return true;
+  }
+
+  /**
+   * Consumer side. Returns false if the ring is empty.
+   */
+  bool pop(T& item) {
+    uint16_t tail = tail_;
+    if (tail == head_) return false;
+    barrier();
+    item = buf_[tail];
+    barrier();                  // Copy out before releasing the slot
+    tail_ = (tail + 1) & (N - 1);
+    return true;
+  }
+
+  /**
+   * Look at the oldest item without removing it
+   */
+  bool peek(T& item) const {
+    uint16_t tail = tail_;
+    if (tail == head_) return false;
+    barrier();
+    item = buf_[tail];
+    return true;
+  }
+
+  uint16_t size() const { return (head_ - tail_) & (N - 1); }
+  bool empty() const { return head_ == tail_; }
+  static constexpr uint16_t capacity() { return N - 1; }
+
+  /**
+   * Consumer side: drop everything currently queued
+   */
+  void clear() { tail_ = head_; }
+
+ private:
+  static inline void barrier() { __asm__ __volatile__("" ::: "memory"); }
+
+  T buf_[N];
+  volatile uint16_t head_ = 0;
+  volatile uint16_t tail_ = 0;
+};
@@ -0,0 +1,149 @@
+// ============================================================================
+// static_string.cpp - StringView / StringBuffer Implementation
+// ============================================================================
+
+#include "static_string.h"
+#include <stdarg.h>
+
+// ============================================================================
+// StringView
+// ============================================================================
+
+size_t StringView::indexOf(char c, size_t from) const {
+  if (from >= len_) return npos;
+  const char* p = (const char*)memchr(data_ + from, c, len_ - from);
+  return p ? (size_t)(p - data_) : npos;
+}
+
+size_t StringView::indexOf(StringView needle, size_t from) const {
+  if (needle.len_ == 0) return from <= len_ ? from : npos;
+  if (needle.len_ > len_) return npos;
+  for (size_t i = from; i + needle.len_ <= len_; i++) {
+    i = indexOf(needle.data_[0], i);
+    if (i == npos || i + needle.len_ > len_) return npos;
+    if (memcmp(data_ + i, needle.data_, needle.len_) == 0) return i;
+  }
+  return npos;
+}
+
+size_t StringView::indexOfIgnoreCase(StringView needle, size_t from) const {
+  if (needle.len_ > len_) return npos;
+  for (size_t i = from; i + needle.len_ <= len_; i++) {
+    if (strncasecmp(data_ + i, needle.data_, needle.len_) == 0) return i;
+  }
+  return npos;
+}
+
+StringView StringView::substr(size_t pos, size_t len) const {
+  if (pos >= len_) return StringView(data_ + len_, 0);
+  size_t avail = len_ - pos;
+  return StringView(data_ + pos, len < avail ? len : avail);
+}
+
+bool StringView::startsWith(StringView prefix) const {
+  return prefix.len_ <= len_ && memcmp(data_, prefix.data_, prefix.len_) == 0;
+}
+
+bool StringView::equals(StringView other) const {
+  return len_ == other.len_ && memcmp(data_, other.data_, len_) == 0;
+}
+
+bool StringView::equalsIgnoreCase(StringView other) const {
+  return len_ == other.len_ && strncasecmp(data_, other.data_, len_) == 0;
+}
+
+StringView StringView::trim() const {
+  size_t b = 0, e = len_;
+  while (b < e && isspace((unsigned char)data_[b])) b++;
+  while (e > b && isspace((unsigned char)data_[e - 1])) e--;
+  return StringView(data_ + b, e - b);
+}
+
+long StringView::toInt() const {
+  size_t i = 0;
+  while (i < len_ && isspace((unsigned char)data_[i])) i++;
+  bool neg = false;
+  if (i < len_ && (data_[i] == '-' || data_[i] == '+')) neg = data_[i++] == '-';
+  long v = 0;
+  while (i < len_ && isdigit((unsigned char)data_[i])) v = v * 10 + (data_[i++] - '0');
+  return neg ? -v : v;
+}
+
+// ============================================================================
+// StringBuffer
+// ============================================================================
+
+void StringBuffer::clear() {
+  len_ = 0;
+  truncated_ = false;
+  buf_[0] = '\0';
+}
+
+bool StringBuffer::assign(StringView s) {
+  len_ = 0;                             // Not clear(): s may be a slice of us
+  truncated_ = false;
+  return append(s);
+}
+
+bool StringBuffer::append(char c) {
+  if (len_ + 1u >= cap_) {
+    truncated_ = true;
+    return false;
+  }
+  buf_[len_++] = c;
+  buf_[len_] = '\0';
+  return true;
+}
+
+bool StringBuffer::append(StringView s) {
+  size_t room = cap_ - 1u - len_;
+  size_t n = s.length();
+  if (n > room) {
+    n = room;
+    truncated_ = true;
+  }
+  memmove(buf_ + len_, s.data(), n);   // s may point into this buffer
+  len_ += n;
+  buf_[len_] = '\0';
+  return n == s.length();
+}
+
+bool StringBuffer::appendf(const char* fmt, ...) {
+  size_t room = cap_ - len_;
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf_ + len_, room, fmt, ap);
+  va_end(ap);
+  if (n < 0) {
+    buf_[len_] = '\0';
+    truncated_ = true;
+    return false;
+  }
+  if ((size_t)n >= room) {
+    len_ = cap_ - 1;
+    truncated_ = true;
+    return false;
+  }
+  len_ += n;
+  return true;
+}
+
+void StringBuffer::truncate(size_t len) {
+  if (len >= len_) return;
+  len_ = len;
+  buf_[len_] = '\0';
+}
+
+void StringBuffer::toUpperCase() {
+  for (uint16_t i = 0; i < len_; i++) buf_[i] = toupper((unsigned char)buf_[i]);
+}
+
+size_t StringBuffer::write(uint8_t c) {
+  return append((char)c) ? 1 : 0;
+}
+
+size_t StringBuffer::write(const uint8_t* data, size_t size) {
+  size_t before = len_;
+  append(StringView((const char*)data, size));
+  return len_ - before;
+}
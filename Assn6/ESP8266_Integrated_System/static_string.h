@@ -0,0 +1,183 @@
+// ============================================================================
+// static_string.h - Fixed-Capacity Strings Without the Heap
+// ============================================================================
+// Purpose: Replace Arduino String on hot paths - every += there is a
+//          malloc/realloc, which fragments the heap the SSL stack needs
+// StringView: Non-owning (pointer, length) window into any text; search,
+//             compare, trim, slice and number parsing without copying
+// StaticString<N>: N bytes of inline storage (stack or static), N - 1
+//                  characters plus the terminator. Appends past the end
+//                  are cut off and flagged via truncated() instead of
+//                  growing. It is a Print, so print(x, decimals) and
+//                  serializeJson() write straight into it.
+// StringSink: Stream adapter so HTTPClient::writeToStream() can fill a
+//             StaticString with a response body
+// Code size: All logic lives in the non-template StringBuffer base
+//            (static_string.cpp); StaticString<N> only adds the storage.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+class StringView {
+ public:
+  static const size_t npos = (size_t)-1;
+
+  constexpr StringView() : data_(""), len_(0) {}
+  constexpr StringView(const char* s, size_t len) : data_(s), len_(len) {}
+  StringView(const char* s) : data_(s ? s : ""), len_(s ? strlen(s) : 0) {}
+
+  const char* data() const { return data_; }
+  size_t length() const { return len_; }
+  bool empty() const { return len_ == 0; }
+  char operator[](size_t i) const { return data_[i]; }
+
+  /**
+   * Position of c / needle at or after from, or npos
+   */
+  size_t indexOf(char c, size_t from = 0) const;
+  size_t indexOf(StringView needle, size_t from = 0) const;
+  size_t indexOfIgnoreCase(StringView needle, size_t from = 0) const;
+
+  /**
+   * Up to len characters from pos (clamped to the view)
+   */
+  StringView substr(size_t pos, size_t len = npos) const;
+
+  bool startsWith(StringView prefix) const;
+  bool equals(StringView other) const;
+  bool equalsIgnoreCase(StringView other) const;
+
+  /**
+   * Without leading and trailing whitespace
+   */
+  StringView trim() const;
+
+  /**
+   * Leading decimal integer (optional sign, leading whitespace skipped);
+   * 0 if there is none - same contract as String::toInt()
+   */
+  long toInt() const;
+
+  bool operator==(StringView other) const { return equals(other); }
+  bool operator!=(StringView other) const { return !equals(other); }
+
+ private:
+  const char* data_;
+  size_t len_;
+};
+
+/**
+ * Storage-agnostic part of StaticString - take this by reference to
+ * accept a StaticString of any capacity
+ */
+class StringBuffer : public Print {
+ public:
+  const char* c_str() const { return buf_; }
+  size_t length() const { return len_; }
+  size_t capacity() const { return cap_ - 1; }
+  bool empty() const { return len_ == 0; }
+  bool truncated() const { return truncated_; }
+  StringView view() const { return StringView(buf_, len_); }
+  operator StringView() const { return view(); }
+
+  void clear();
+
+  /**
+   * Replace the contents; false if cut off
+   */
+  bool assign(StringView s);
+
+  /**
+   * Append; false (and truncated() set) if not everything fit
+   */
+  bool append(char c);
+  bool append(StringView s);
+
+  /**
+   * printf-style append straight into the buffer (no temporary)
+   */
+  bool appendf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+  /**
+   * Shorten to len characters (no-op if already shorter)
+   */
+  void truncate(size_t len);
+
+  void toUpperCase();
+
+  bool operator==(StringView s) const { return view().equals(s); }
+  bool operator!=(StringView s) const { return !view().equals(s); }
+  StringBuffer& operator+=(char c) { append(c); return *this; }
+  StringBuffer& operator+=(StringView s) { append(s); return *this; }
+
+  // Print - lets print()/println()/serializeJson() append
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* data, size_t size) override;
+  using Print::write;
+
+ protected:
+  StringBuffer(char* buf, size_t cap) : buf_(buf), cap_(cap), len_(0), truncated_(false) {
+    buf_[0] = '\0';
+  }
+  StringBuffer(const StringBuffer&) = delete;
+  StringBuffer& operator=(const StringBuffer&) = delete;
+
+ private:
+  char* buf_;
+  uint16_t cap_;           // Including the terminator
+  uint16_t len_;
+  bool truncated_;
+};
+
+template <size_t N>
+class StaticString : public StringBuffer {
+  static_assert(N >= 2 && N <= 0xFFFF, "StaticString capacity out of range");
+
+ public:
+  StaticString() : StringBuffer(storage_, N) {}
+  StaticString(StringView s) : StringBuffer(storage_, N) { assign(s); }
+  StaticString(const char* s) : StringBuffer(storage_, N) { assign(s); }
+  StaticString(const StaticString& other) : StringBuffer(storage_, N) { assign(other); }
+
+  StaticString& operator=(const StaticString& other) {
+    if (this != &other) assign(other);
+    return *this;
+  }
+  StaticString& operator=(StringView s) {
+    assign(s);
+    return *this;
+  }
+  StaticString& operator=(const char* s) {
+    assign(s);
+    return *this;
+  }
+
+ private:
+  char storage_[N];
+};
+
+/**
+ * Write-only Stream over a StringBuffer (reads report end of data).
+ * Always claims the full write so a producer such as writeToStream()
+ * drains its source; an overflow shows up as out.truncated().
+ */
+class StringSink : public Stream {
+ public:
+  explicit StringSink(StringBuffer& out) : out_(out) {}
+
+  size_t write(uint8_t c) override {
+    out_.append((char)c);
+    return 1;
+  }
+  size_t write(const uint8_t* data, size_t size) override {
+    out_.append(StringView((const char*)data, size));
+    return size;
+  }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+
+ private:
+  StringBuffer& out_;
+};
@@ -1,127 +1,85 @@
 // ============================================================================
-// switches.cpp - Dual Switch Implementation - IMPROVED RESPONSIVENESS
+// switches.cpp - Dual Switch Implementation - TIMER-SAMPLED INPUTS
+// ============================================================================
+// Both switches are conditioned by the input module (inputs.h): sampled and
+// debounced on the timer0 interrupt, so presses made while loop() is
+// blocked (HTTPS calls) are queued as events and counted afterwards.
 // ============================================================================
 
 #include "switches.h"
 #include "config.h"
+#include "logger.h"
+#include "kvstore.h"
+#include "gpio_hal.h"
+#include "inputs.h"
+#include "events.h"
+
+typedef GpioPin<PIN_SWITCH_1> Switch1Pin;
+typedef GpioPin<PIN_SWITCH_2> Switch2Pin;
 
-// Event flags (set by pollSwitches, cleared by takeXxxEvent)
-static volatile bool sw1Evt = false;
-static volatile bool sw2Evt = false;
+// Indexed by switch number - 1
+static const uint8_t switchPins[2] = {PIN_SWITCH_1, PIN_SWITCH_2};
+static const char* const switchActions[2] = {"Sensor Logging", "Status Check"};
 
-// Activity counters
+// Activity counters (persisted in the KV store across restarts)
 static uint32_t count1 = 0;
 static uint32_t count2 = 0;
 
-// Debouncing state
-static uint8_t sw1State = HIGH;
-static uint8_t sw2State = HIGH;
-static uint8_t sw1LastReading = HIGH;
-static uint8_t sw2LastReading = HIGH;
-static uint32_t sw1LastDebounceTime = 0;
-static uint32_t sw2LastDebounceTime = 0;
-
 /**
  * Initialize GPIO pins for switches
  */
 void switchesBegin() {
-  pinMode(PIN_SWITCH_1, INPUT_PULLUP);  // GPIO0 has internal pull-up
-  pinMode(PIN_SWITCH_2, INPUT_PULLUP);  // GPIO16 needs explicit pull-up
+  Switch1Pin::inputPullup();  // GPIO0 has internal pull-up
+  Switch2Pin::input();        // GPIO16 needs an external pull-up
+  
+  // Restore counters and tunables
+  count1 = kvGetU32(KV_SWITCH1_COUNT, 0);
+  count2 = kvGetU32(KV_SWITCH2_COUNT, 0);
   
-  // Read initial state
-  sw1State = digitalRead(PIN_SWITCH_1);
-  sw2State = digitalRead(PIN_SWITCH_2);
-  sw1LastReading = sw1State;
-  sw2LastReading = sw2State;
+  inputsBegin(kvGetU32(KV_DEBOUNCE_MS, DEBOUNCE_DELAY_MS));
+  for (uint8_t i = 0; i < 2; i++) {
+    inputAttach(switchPins[i]);
+  }
   
-  Serial.println("[SWITCHES] Initialized:");
-  Serial.println("  Switch 1 (GPIO0)  -> Sensor logging");
-  Serial.println("  Switch 2 (GPIO16) -> LED/RGB status");
+  LOGI("SWITCHES", "Switch 1 (GPIO0) -> Sensor logging, Switch 2 (GPIO16) -> LED/RGB status");
+  LOGI("SWITCHES", "Counts restored: %lu / %lu", (unsigned long)count1, (unsigned long)count2);
 }
 
 /**
- * Poll both switches with improved debouncing
+ * Forward debounced input events to the application event queue
  * Call this frequently in the main loop
  */
 void pollSwitches() {
-  uint32_t now = millis();
-  
-  // ====== SWITCH 1 (GPIO0) ======
-  uint8_t reading1 = digitalRead(PIN_SWITCH_1);
-  
-  // Check if reading changed (potential bounce or real change)
-  if (reading1 != sw1LastReading) {
-    sw1LastDebounceTime = now;  // Reset debounce timer
-  }
-  
-  // If reading has been stable for debounce period
-  if ((now - sw1LastDebounceTime) > DEBOUNCE_DELAY_MS) {
-    // If the reading is different from the current state, update state
-    if (reading1 != sw1State) {
-      sw1State = reading1;
+  InputEvent ev;
+  while (inputTakeEvent(ev)) {
+    for (uint8_t i = 0; i < 2; i++) {
+      if (ev.pin != switchPins[i]) continue;
+      EventSource src = (EventSource)(EVT_SRC_SWITCH1 + i);
       
-      // Trigger event on press (falling edge, LOW = pressed)
-      if (sw1State == LOW) {
-        sw1Evt = true;
-        Serial.println("\n[SWITCH 1] ✓ Pressed -> Sensor Logging");
+      if (ev.type == INPUT_EV_PRESS) {
+        eventPost(src, EVT_PRESS, ev.timestamp);
+        LOGI("SWITCH", "%u pressed -> %s", i + 1, switchActions[i]);
+      } else if (ev.type == INPUT_EV_LONG_PRESS) {
+        LOGI("SWITCH", "%u long press (no action)", i + 1);
       }
+      // Releases and INPUT_EV_REPEAT are not used: neither switch has a
+      // hold action, and queueing them unconsumed would fill the queue
     }
   }
-  
-  sw1LastReading = reading1;
-  
-  // ====== SWITCH 2 (GPIO16) ======
-  uint8_t reading2 = digitalRead(PIN_SWITCH_2);
-  
-  if (reading2 != sw2LastReading) {
-    sw2LastDebounceTime = now;
-  }
-  
-  if ((now - sw2LastDebounceTime) > DEBOUNCE_DELAY_MS) {
-    if (reading2 != sw2State) {
-      sw2State = reading2;
-      
-      if (sw2State == LOW) {
-        sw2Evt = true;
-        Serial.println("\n[SWITCH 2] ✓ Pressed -> Status Check");
-      }
-    }
-  }
-  
-  sw2LastReading = reading2;
 }
 
-/**
- * Take and clear switch 1 event
- */
-bool takeSwitch1Event() {
-  if (sw1Evt) {
-    sw1Evt = false;
-    return true;
-  }
-  return false;
+bool switchesSetDebounce(uint32_t ms) {
+  if (ms < DEBOUNCE_MIN_MS || ms > DEBOUNCE_MAX_MS) return false;
+  inputsBegin(ms);   // Re-derives the tick decimation, events stay queued
+  kvPutU32(KV_DEBOUNCE_MS, ms);
+  return true;
 }
 
 /**
- * Take and clear switch 2 event
+ * Input events lost because the queue was full (should stay 0)
  */
-bool takeSwitch2Event() {
-  if (sw2Evt) {
-    sw2Evt = false;
-    return true;
-  }
-  return false;
-}
-
-/**
- * Check if button is currently being held down
- */
-bool isSwitch1Pressed() {
-  return (sw1State == LOW);
-}
-
-bool isSwitch2Pressed() {
-  return (sw2State == LOW);
+uint32_t switchEventsDropped() {
+  return inputStats().dropped;
 }
 
 /**
@@ -129,5 +87,10 @@ bool isSwitch2Pressed() {
  */
 uint32_t switch1Count() { return count1; }
 uint32_t switch2Count() { return count2; }
-void incSwitch1() { count1++; }
-void incSwitch2() { count2++; }
+void incSwitch1(uint32_t n) { kvPutU32(KV_SWITCH1_COUNT, count1 += n); }
+void incSwitch2(uint32_t n) { kvPutU32(KV_SWITCH2_COUNT, count2 += n); }
+
+void switchesRestoreCounts(uint32_t c1, uint32_t c2) {
+  if (c1 > count1) incSwitch1(c1 - count1);
+  if (c2 > count2) incSwitch2(c2 - count2);
+}
@@ -4,6 +4,8 @@
 // Purpose: Handle two independent switches with debouncing
 // Switch 1 (GPIO0):  Triggers Part 1 - Sensor logging to Slack/Google Sheets
 // Switch 2 (GPIO16): Triggers Part 2 - LED/RGB status check and messaging
+// Capture: Vertical-counter debouncer on the timer0 tick (inputs.h);
+//          events are queued, so no press is lost while loop() is blocked
 // ============================================================================
 
 #pragma once
@@ -15,22 +17,22 @@
 void switchesBegin();
 
 /**
- * Poll both switches for state changes (call every loop iteration)
- * Handles debouncing internally (50ms)
+ * Forward debounced presses to the event queue (call every loop iteration)
+ * as EVT_SRC_SWITCH1 / EVT_SRC_SWITCH2 (events.h)
+ * Debounce time: 50ms default, KV_DEBOUNCE_MS
  */
 void pollSwitches();
 
 /**
- * Check and consume switch 1 event
- * Returns true if switch 1 was pressed since last check
+ * Change the debounce time and persist it (KV_DEBOUNCE_MS)
+ * @return false if out of range (DEBOUNCE_MIN_MS..DEBOUNCE_MAX_MS)
  */
-bool takeSwitch1Event();
+bool switchesSetDebounce(uint32_t ms);
 
 /**
- * Check and consume switch 2 event
- * Returns true if switch 2 was pressed since last check
+ * Input events lost because the event queue overflowed
  */
-bool takeSwitch2Event();
+uint32_t switchEventsDropped();
 
 /**
  * Get activity counters (number of times each switch was pressed)
@@ -40,6 +42,14 @@ uint32_t switch2Count();
 
 /**
  * Increment activity counters (called after successful actions)
+ * @param n Number of presses handled (coalesced events count individually)
+ * Counters are persisted, so they survive restarts
  */
-void incSwitch1();
-void incSwitch2();
+void incSwitch1(uint32_t n = 1);
+void incSwitch2(uint32_t n = 1);
+
+/**
+ * Raise the counters to at least these values (RTC copy kept across
+ * deep sleep, see power.h) - persisted if they were behind
+ */
+void switchesRestoreCounts(uint32_t c1, uint32_t c2);
@@ -0,0 +1,276 @@
+// ============================================================================
+// task_sched.cpp - Cooperative Task Scheduler Implementation
+// ============================================================================
+
+#include "task_sched.h"
+#include "config.h"
+#include "logger.h"
+#include <coredecls.h>
+
+static const uint8_t WHEEL_BITS = 6;
+static const uint8_t WHEEL_SLOTS = 1 << WHEEL_BITS;   // 64
+static const uint8_t WHEEL_LEVELS = 3;
+static const uint32_t WHEEL_SPAN = 1UL << (WHEEL_BITS * WHEEL_LEVELS);
+
+static SchedTask* wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+static uint64_t occupied[WHEEL_LEVELS];   // Bit n = slot n non-empty
+static uint32_t curTick = 0;              // Last tick processed
+static bool started = false;
+
+static SchedTask* tasks[SCHED_MAX_TASKS];  // For profiling
+static uint8_t taskCount = 0;
+
+static volatile bool wakeRequested = false;
+static uint32_t sleeps = 0;
+static uint32_t wakeups = 0;
+static uint32_t sleptMs = 0;
+static LatencyHistogram loopHist;
+
+static inline uint8_t slotOf(uint32_t tick, uint8_t level) {
+  return (tick >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1);
+}
+
+static void unlink(SchedTask& t) {
+  if (!t.queued) return;
+  if (t.prev) t.prev->next = t.next;
+  else wheel[t.level][t.slot] = t.next;
+  if (t.next) t.next->prev = t.prev;
+  if (!wheel[t.level][t.slot]) occupied[t.level] &= ~(1ULL << t.slot);
+  t.queued = false;
+}
+
+/**
+ * Place a task by its distance from the current tick. The current tick's
+ * level-0 slot is only still pending while cascading into it.
+ */
+static void insert(SchedTask& t, bool cascading = false) {
+  uint32_t earliest = curTick + (cascading ? 0 : 1);
+  if ((int32_t)(t.due - earliest) < 0) t.due = earliest;
+  uint32_t delta = t.due - curTick;
+
+  uint8_t level = 0;
+  uint32_t at = t.due;
+  if (delta >= WHEEL_SPAN) {
+    level = WHEEL_LEVELS - 1;               // Re-cascades until in range
+    at = curTick + WHEEL_SPAN - 1;
+  } else {
+    while (level < WHEEL_LEVELS - 1 && delta >= (1UL << (WHEEL_BITS * (level + 1)))) {
+      level++;
+    }
+  }
+
+  t.level = level;
+  t.slot = slotOf(at, level);
+  t.prev = nullptr;
+  t.next = wheel[level][t.slot];
+  if (t.next) t.next->prev = &t;
+  wheel[level][t.slot] = &t;
+  occupied[level] |= 1ULL << t.slot;
+  t.queued = true;
+}
+
+/**
+ * Re-insert every task of a higher-level slot (they move down a level)
+ */
+static void cascade(uint8_t level, uint8_t slot) {
+  SchedTask* t = wheel[level][slot];
+  wheel[level][slot] = nullptr;
+  occupied[level] &= ~(1ULL << slot);
+  while (t) {
+    SchedTask* next = t->next;
+    t->queued = false;
+    insert(*t, true);
+    t = next;
+  }
+}
+
+static void registerTask(SchedTask& t, const char* name, SchedFn fn) {
+  if (!started) {
+    curTick = millis();
+    started = true;
+  }
+  unlink(t);
+  t.name = name;
+  t.fn = fn;
+  if (!t.registered && taskCount < SCHED_MAX_TASKS) {
+    tasks[taskCount++] = &t;
+    t.registered = true;
+    profileRegister(t.hist, name);
+  }
+}
+
+void schedEvery(SchedTask& task, const char* name, SchedFn fn, uint32_t periodMs,
+                uint32_t firstMs) {
+  registerTask(task, name, fn);
+  task.period = periodMs ? periodMs : 1;
+  task.due = millis() + firstMs;
+  insert(task);
+}
+
+void schedAfter(SchedTask& task, const char* name, SchedFn fn, uint32_t delayMs) {
+  registerTask(task, name, fn);
+  task.period = 0;
+  task.due = millis() + delayMs;
+  insert(task);
+}
+
+void schedSetPeriod(SchedTask& task, uint32_t periodMs) {
+  if (!task.registered || periodMs == 0) return;
+  task.period = periodMs;
+  if (task.queued) {
+    unlink(task);
+    task.due = millis() + periodMs;
+    insert(task);
+  }
+}
+
+void schedCancel(SchedTask& task) {
+  unlink(task);
+  task.period = 0;   // Also stops a task cancelling itself from re-arming
+}
+
+/**
+ * Run one task and record its profile
+ */
+static void runTask(SchedTask& t, uint32_t now) {
+  uint32_t c0 = ESP.getCycleCount();
+  t.fn();
+  uint32_t us = (ESP.getCycleCount() - c0) / profileCyclesPerUs;
+  t.hist.record(us);
+  t.runs++;
+  t.totalUs += us;
+  if (us > t.maxUs) t.maxUs = us;
+
+  // Periodic: keep the phase, skip periods missed while the loop was blocked
+  if (t.period && !t.queued) {
+    t.due += t.period;
+    if ((int32_t)(now - t.due) >= 0) {
+      uint32_t missed = (now - t.due) / t.period + 1;
+      t.late += missed;
+      t.due += missed * t.period;
+    }
+    insert(t);
+  }
+}
+
+/**
+ * Advance the wheel to now, running tasks tick by tick
+ */
+static void advance(uint32_t now) {
+  while ((int32_t)(now - curTick) > 0) {
+    curTick++;
+
+    // Crossing a level boundary - bring the next slot of the upper level down
+    if (slotOf(curTick, 0) == 0) {
+      if (slotOf(curTick, 1) == 0) cascade(2, slotOf(curTick, 2));
+      cascade(1, slotOf(curTick, 1));
+    }
+
+    uint8_t slot = slotOf(curTick, 0);
+    if (!(occupied[0] & (1ULL << slot))) continue;
+
+    // Detach the slot first - tasks may re-arm themselves into it
+    SchedTask* t = wheel[0][slot];
+    wheel[0][slot] = nullptr;
+    occupied[0] &= ~(1ULL << slot);
+    while (t) {
+      SchedTask* next = t->next;
+      if (next) next->prev = nullptr;
+      t->queued = false;
+      t->next = nullptr;
+      runTask(*t, now);
+      t = next;
+    }
+  }
+}
+
+/**
+ * Ticks from the current one to the next occupied slot of a level,
+ * measured in that level's slots (0 = none)
+ */
+static uint32_t slotsAhead(uint8_t level) {
+  uint64_t occ = occupied[level];
+  if (!occ) return 0;
+  uint8_t from = (slotOf(curTick, level) + 1) & (WHEEL_SLOTS - 1);
+  uint64_t rot = (occ >> from) | (from ? (occ << (WHEEL_SLOTS - from)) : 0);
+  return __builtin_ctzll(rot) + 1;
+}
+
+uint32_t schedIdleMs() {
+  uint32_t wait = SCHED_MAX_SLEEP_MS;
+
+  // Level 0 holds exact deadlines
+  uint32_t n = slotsAhead(0);
+  if (n && n < wait) wait = n;
+
+  // Upper levels: wake at the start of the next occupied slot to cascade
+  for (uint8_t level = 1; level < WHEEL_LEVELS; level++) {
+    n = slotsAhead(level);
+    if (!n) continue;
+    uint32_t start = ((curTick >> (WHEEL_BITS * level)) + n) << (WHEEL_BITS * level);
+    uint32_t w = start - curTick;
+    if (w < wait) wait = w;
+  }
+
+  // Time already spent since curTick counts against the wait
+  uint32_t spent = millis() - curTick;
+  return (spent >= wait) ? 0 : wait - spent;
+}
+
+LatencyHistogram& schedLoopHistogram() {
+  return loopHist;
+}
+
+uint32_t schedSleptMs() {
+  return sleptMs;
+}
+
+void schedRunOnWake(SchedTask& task, bool enable) {
+  task.onWake = enable;
+}
+
+void IRAM_ATTR schedWake() {
+  wakeRequested = true;
+  esp_schedule();
+}
+
+void schedRun() {
+  uint32_t c0 = ESP.getCycleCount();
+  if (wakeRequested) {
+    wakeRequested = false;
+    for (uint8_t i = 0; i < taskCount; i++) {
+      if (tasks[i]->onWake && tasks[i]->queued) runTask(*tasks[i], millis());
+    }
+  }
+
+  advance(millis());
+  loopHist.recordCycles(ESP.getCycleCount() - c0);
+
+  uint32_t idle = schedIdleMs();
+  if (idle == 0 || wakeRequested) {
+    yield();
+    return;
+  }
+
+  sleeps++;
+  uint32_t t0 = millis();
+  esp_delay(idle, []() { return !wakeRequested; });
+  sleptMs += millis() - t0;
+  if (wakeRequested) wakeups++;
+}
+
+void schedPrintProfile() {
+  CONSOLE("\n[SCHED] Task profile:\n");
+  CONSOLE("  Task         Period     Runs   Avg us   Max us   Late\n");
+  for (uint8_t i = 0; i < taskCount; i++) {
+    const SchedTask& t = *tasks[i];
+    CONSOLE("  %-12s %6lu %8lu %8lu %8lu %6lu%s\n",
+            t.name, (unsigned long)t.period, (unsigned long)t.runs,
+            (unsigned long)(t.runs ? t.totalUs / t.runs : 0),
+            (unsigned long)t.maxUs, (unsigned long)t.late,
+            t.queued ? "" : " (idle)");
+  }
+  CONSOLE("  Sleeps: %lu, early wakeups: %lu, idle %lu%%\n",
+          (unsigned long)sleeps, (unsigned long)wakeups,
+          (unsigned long)(millis() ? (uint64_t)sleptMs * 100 / millis() : 0));
+}
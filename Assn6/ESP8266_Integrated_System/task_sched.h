@@ -0,0 +1,104 @@
+// ============================================================================
+// task_sched.h - Cooperative Task Scheduler (Hierarchical Timer Wheel)
+// ============================================================================
+// Purpose: Run module jobs at their deadlines and sleep in between, instead
+//          of polling every module on every loop() pass
+// Method: Three-level timer wheel (64 slots per level, 1 ms tick):
+//           level 0: 1 ms slots     (< 64 ms ahead)
+//           level 1: 64 ms slots    (< 4.1 s ahead)
+//           level 2: 4096 ms slots  (< 4.4 min ahead, longer waits re-cascade)
+//         Insert/cancel are O(1); a slot bitmap per level gives the next
+//         deadline with one bit scan, so loop() sleeps exactly until then.
+// Wakeups: schedWake() (ISR safe) cuts the sleep short, e.g. on input events
+// Profiling: Every task records runs, total and worst-case run time
+// Tasks are statically allocated by their owners; no heap.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include "profile.h"
+
+typedef void (*SchedFn)();
+
+/**
+ * One task. Owned by the module that registers it; fields are private to
+ * task_sched.cpp.
+ */
+struct SchedTask {
+  SchedTask* next;
+  SchedTask* prev;
+  const char* name;
+  SchedFn fn;
+  uint32_t due;           // Tick (millis) of the next run
+  uint32_t period;        // 0 = one-shot
+  uint8_t level;          // Wheel position while queued
+  uint8_t slot;
+  bool queued;
+  bool registered;
+  bool onWake;            // Also run whenever schedWake() ends a sleep
+
+  // Profile
+  uint32_t runs;
+  uint32_t totalUs;
+  uint32_t maxUs;
+  uint32_t late;          // Periods skipped because the loop was blocked
+  LatencyHistogram hist;  // Run time distribution ('P')
+};
+
+/**
+ * Run a task every periodMs, first after firstMs
+ */
+void schedEvery(SchedTask& task, const char* name, SchedFn fn, uint32_t periodMs,
+                uint32_t firstMs = 0);
+
+/**
+ * Run a task once after delayMs (re-arming a queued task moves it)
+ */
+void schedAfter(SchedTask& task, const char* name, SchedFn fn, uint32_t delayMs);
+
+/**
+ * Change the period of a periodic task (takes effect from now)
+ */
+void schedSetPeriod(SchedTask& task, uint32_t periodMs);
+
+/**
+ * Remove a task from the wheel
+ */
+void schedCancel(SchedTask& task);
+
+/**
+ * Also run a task as soon as schedWake() is called (e.g. input handling),
+ * besides its normal deadline
+ */
+void schedRunOnWake(SchedTask& task, bool enable = true);
+
+/**
+ * Run every due task, then sleep until the next deadline or schedWake()
+ * Call from loop() - it is the whole loop body.
+ */
+void schedRun();
+
+/**
+ * Milliseconds until the next deadline (capped at SCHED_MAX_SLEEP_MS)
+ */
+uint32_t schedIdleMs();
+
+/**
+ * Total time spent sleeping in schedRun() since boot (for power accounting)
+ */
+uint32_t schedSleptMs();
+
+/**
+ * End the current sleep early (ISR safe)
+ */
+void schedWake();
+
+/**
+ * Histogram of the work done per schedRun() pass (sleep excluded)
+ */
+LatencyHistogram& schedLoopHistogram();
+
+/**
+ * Print per-task run-time profile to Serial
+ */
+void schedPrintProfile();
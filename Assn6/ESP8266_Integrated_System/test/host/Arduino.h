@@ -0,0 +1,102 @@
+// ============================================================================
+// test/host/Arduino.h - Minimal Arduino Core for Host Tests
+// ============================================================================
+// Purpose: Just enough of the ESP8266 Arduino core for the hardware-free
+//          modules (static_string, profile, logger, heap_trace) to compile
+//          and run on a PC under `pio test -e native`
+// Serial: Captures everything written into hostSerial for inspection
+// Clock: millis() and ESP.getCycleCount() return hostMillis / hostCycles,
+//        which tests set directly
+// ============================================================================
+
+#pragma once
+#include <ctype.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// ==== Program memory (flat address space on the host) ====
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define strlen_P strlen
+#define memcpy_P memcpy
+#define vsnprintf_P vsnprintf
+#define snprintf_P snprintf
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+
+#define IRAM_ATTR
+
+template <typename T>
+constexpr const T& constrain(const T& v, const T& lo, const T& hi) {
+  return v < lo ? lo : (hi < v ? hi : v);
+}
+template <typename T>
+constexpr const T& min(const T& a, const T& b) { return b < a ? b : a; }
+template <typename T>
+constexpr const T& max(const T& a, const T& b) { return a < b ? b : a; }
+
+inline uint32_t hostMillis = 0;
+inline uint32_t hostCycles = 0;
+
+inline uint32_t millis() { return hostMillis; }
+inline void noInterrupts() {}
+inline void interrupts() {}
+inline uint32_t xt_rsil(uint32_t) { return 0; }
+inline void xt_wsr_ps(uint32_t) {}
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* data, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*data++);
+    return n;
+  }
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  virtual void flush() {}
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+};
+
+/**
+ * UART stand-in: output collects in out[] (cut off at the end)
+ */
+class HostSerial : public Stream {
+ public:
+  uint8_t out[4096];
+  size_t len = 0;
+
+  size_t write(uint8_t c) override {
+    if (len < sizeof(out)) out[len++] = c;
+    return 1;
+  }
+  using Print::write;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  int availableForWrite() { return 128; }
+  void clear() { len = 0; }
+};
+inline HostSerial Serial;
+
+class EspClass {
+ public:
+  uint32_t getCycleCount() { return hostCycles; }
+  uint8_t getCpuFreqMHz() { return 80; }
+  uint32_t getFreeHeap() { return 40000; }
+  uint32_t getMaxFreeBlockSize() { return 30000; }
+  uint8_t getHeapFragmentation() { return 10; }
+};
+inline EspClass ESP;
@@ -0,0 +1,36 @@
+// ============================================================================
+// capture.cpp - Tokenized Log Capture for test_log_decode.py
+// ============================================================================
+// Built and run by test_log_decode.py: logs a fixed set of lines through the
+// real tokenized encoder (logger.cpp, -D LOG_TOKENIZED) against the core
+// stand-in in test/host, then writes the raw Serial bytes to stdout. The
+// Python side feeds them to log_decode.Decoder and checks the text.
+// Keep the calls here in step with EXPECTED in test_log_decode.py.
+// ============================================================================
+
+#define LOG_TOKENIZED
+#define LOG_LOCAL_LEVEL LOG_DEBUG
+#include "logger.cpp"
+
+// Drain is write-through until logBegin(), so the scheduler is never used
+void schedAfter(SchedTask&, const char*, SchedFn, uint32_t) {}
+
+int main() {
+  char big[300];
+  memset(big, 'a', sizeof(big) - 1);
+  big[sizeof(big) - 1] = '\0';
+
+  CONSOLE("=== boot ===\n");
+  LOGI("CAP", "n=%d u=%u x=%08lX c=%c", -5, 300u, 0xDEADBEEFUL, 'x');
+  LOGW("CAP", "min=%ld max=%lu", (long)INT32_MIN, (unsigned long)UINT32_MAX);
+  LOGE("CAP", "%d%% done", 100);
+  LOGI("CAP", "%s = %.1f %s (z = %.2f)", "Lux", 412.5, "lx", -3.25);
+  LOGD("CAP", "Reply: '%-6s' len %u", "", 0u);
+  LOGI("CAP", "%s", "22.5 \xC2\xB0" "C");
+  CONSOLE("menu\n");
+  LOGI("CAP", "long %s end %d", big, 7);
+  LOGW("CAP", "no arguments");
+
+  fwrite(Serial.out, 1, Serial.len, stdout);
+  return 0;
+}
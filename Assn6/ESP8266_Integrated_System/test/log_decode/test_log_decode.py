@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+# ============================================================================
+# test_log_decode.py - Host Test for tools/log_decode.py
+# ============================================================================
+# Run: python3 test/log_decode/test_log_decode.py   (needs a host g++, or $CXX)
+# Builds capture.cpp against the real tokenized encoder, then feeds its raw
+# output to log_decode.Decoder with a token table scanned from the sources,
+# so a change on either side (record framing, varints, zigzag, CRC, format
+# parsing, source scan) shows up as a wrong line here.
+# ============================================================================
+
+import io
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+PROJECT = os.path.dirname(os.path.dirname(HERE))
+sys.path.insert(0, os.path.join(PROJECT, "tools"))
+
+import log_decode  # noqa: E402
+
+CXX = os.environ.get("CXX", "g++")
+
+# What capture.cpp logs, as a text build would print it
+EXPECTED = [
+    "=== boot ===",
+    "I [CAP] n=-5 u=300 x=DEADBEEF c=x",
+    "W [CAP] min=-2147483648 max=4294967295",
+    "E [CAP] 100% done",
+    "I [CAP] Lux = 412.5 lx (z = -3.25)",
+    "D [CAP] Reply: '      ' len 0",
+    "I [CAP] 22.5 °C",
+    "menu",
+    re.compile(r"I \[CAP\] long a+ end \?"),   # String filled the record
+    "W [CAP] no arguments",
+]
+
+
+@unittest.skipUnless(shutil.which(CXX), "no host C++ compiler")
+class DecodeCaptureTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        with tempfile.TemporaryDirectory() as tmp:
+            exe = os.path.join(tmp, "capture")
+            subprocess.run([CXX, "-std=gnu++17", "-I", os.path.join(PROJECT, "test", "host"),
+                            "-I", PROJECT, os.path.join(HERE, "capture.cpp"), "-o", exe],
+                           check=True)
+            cls.capture = subprocess.run([exe], check=True, stdout=subprocess.PIPE).stdout
+        cls.table = log_decode.scan_sources(PROJECT)
+
+    def decode(self, chunks, table=None):
+        out = io.StringIO()
+        dec = log_decode.Decoder(self.table if table is None else table, out, levels=True)
+        for c in chunks:
+            dec.feed(c)
+        return out.getvalue().splitlines(), dec.bad
+
+    def check_lines(self, lines):
+        self.assertEqual(len(EXPECTED), len(lines))
+        for want, got in zip(EXPECTED, lines):
+            if isinstance(want, str):
+                self.assertEqual(want, got)
+            else:
+                self.assertRegex(got, want)
+
+    def test_whole_capture(self):
+        lines, bad = self.decode([self.capture])
+        self.check_lines(lines)
+        self.assertEqual(0, bad)
+
+    def test_byte_at_a_time(self):
+        # Serial reads split records and UTF-8 anywhere
+        lines, bad = self.decode(self.capture[i:i + 1] for i in range(len(self.capture)))
+        self.check_lines(lines)
+        self.assertEqual(0, bad)
+
+    def test_resync_after_bad_record(self):
+        # Attached mid-stream: a mark and length with a body that fails the CRC
+        junk = b"\xff\x09partial\x00\x00\x00\n"
+        lines, bad = self.decode([junk + self.capture])
+        self.assertEqual(1, bad)                # Only the mark is dropped
+        self.check_lines(lines[1:])
+
+    def test_unknown_token(self):
+        lines, _ = self.decode([self.capture], table={})
+        self.assertRegex(lines[1], r"^I \[\?\] unknown token 0x[0-9A-F]{8} \(\d+ argument bytes\)")
+
+    def test_firmware_sources_scanned(self):
+        texts = {(t, f) for entries in self.table.values() for t, f, _ in entries}
+        self.assertIn((b"CONTROL", b"No WiFi - skipping LED poll"), texts)
+        self.assertIn((b"CAP", b"%s = %.1f %s (z = %.2f)"), texts)
+        for token, entries in self.table.items():
+            self.assertEqual(1, len({(t, f) for t, f, _ in entries}), "collision 0x%08X" % token)
+
+
+if __name__ == "__main__":
+    unittest.main()
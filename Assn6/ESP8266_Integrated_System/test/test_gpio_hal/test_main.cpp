@@ -0,0 +1,86 @@
+// ============================================================================
+// test_gpio_hal - Host Tests for the GPIO HAL Register Mock
+// ============================================================================
+// Run: pio test -e native
+// gpio_hal.h without ARDUINO maps the registers onto gpioHost, so pin
+// writes, reads and direction changes can be checked on a PC.
+// ============================================================================
+
+#include <unity.h>
+#include "gpio_hal.h"
+
+typedef GpioPin<5> Led;
+typedef GpioPin<0> Button;
+typedef GpioPin<16> Wake;
+
+static_assert(gpioPinsDistinct<0, 2, 4, 5, 12, 13, 14, 15, 16>(), "Usable pins");
+static_assert(!gpioPinsDistinct<4, 4>(), "Shared pin must be rejected");
+static_assert(!gpioPinsDistinct<4, 7>(), "Flash pin must be rejected");
+
+void setUp() {
+  gpioHost = {};
+}
+
+void tearDown() {}
+
+static void test_write_is_one_register_access() {
+  Led::output();
+  TEST_ASSERT_EQUAL_HEX32(1UL << 5, gpioHost.enable);
+
+  gpioHost.accesses = 0;
+  Led::high();
+  TEST_ASSERT_EQUAL_HEX32(1UL << 5, gpioHost.out);
+  TEST_ASSERT_TRUE(Led::state());
+  Led::low();
+  TEST_ASSERT_EQUAL_HEX32(0, gpioHost.out);
+  TEST_ASSERT_EQUAL(3, gpioHost.accesses);   // high, state, low
+}
+
+static void test_pullup_and_read() {
+  Button::inputPullup();
+  TEST_ASSERT_EQUAL_HEX32(1UL << 0, gpioHost.pullup);
+  TEST_ASSERT_EQUAL_HEX32(0, gpioHost.enable);
+
+  gpioHost.in = 1UL << 0;
+  TEST_ASSERT_TRUE(Button::read());
+  gpioHost.in = 0;
+  TEST_ASSERT_FALSE(Button::read());
+}
+
+static void test_gpio16_uses_rtc_block() {
+  Wake::output();
+  TEST_ASSERT_TRUE(gpioHost.enable16);
+  Wake::high();
+  TEST_ASSERT_TRUE(gpioHost.out16);
+  TEST_ASSERT_EQUAL_HEX32(0, gpioHost.out);   // GPO untouched
+
+  gpioWrite(16, false);
+  TEST_ASSERT_FALSE(gpioHost.out16);
+}
+
+static void test_read_all_merges_gpio16() {
+  gpioHost.in = (1UL << 0) | (1UL << 14) | (1UL << 20);   // Bit 20 is not a pin
+  gpioHost.in16 = true;
+  TEST_ASSERT_EQUAL_HEX32((1UL << 0) | (1UL << 14) | (1UL << 16), gpioReadAll());
+  TEST_ASSERT_TRUE(gpioRead(16));
+  TEST_ASSERT_FALSE(gpioRead(2));
+}
+
+static void test_drive_switches_direction_only() {
+  gpioHost.out = 1UL << 4;
+  gpioDrive(4, true);
+  TEST_ASSERT_EQUAL_HEX32(1UL << 4, gpioHost.enable);
+  gpioDrive(4, false);
+  TEST_ASSERT_EQUAL_HEX32(0, gpioHost.enable);
+  TEST_ASSERT_EQUAL_HEX32(1UL << 4, gpioHost.out);   // Level kept
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_write_is_one_register_access);
+  RUN_TEST(test_pullup_and_read);
+  RUN_TEST(test_gpio16_uses_rtc_block);
+  RUN_TEST(test_read_all_merges_gpio16);
+  RUN_TEST(test_drive_switches_direction_only);
+  return UNITY_END();
+}
@@ -0,0 +1,159 @@
+// ============================================================================
+// test_heap_trace.cpp - Pointer Table Probing and Backward-Shift Delete
+// ============================================================================
+// The wrappers are driven with made-up block addresses (nothing is really
+// allocated), picked so that they collide in the hash table.
+// ============================================================================
+
+#include <unity.h>
+#define HEAP_TRACE
+#include "heap_trace.cpp"
+
+static const uint16_t MASK = HEAP_TRACE_SLOTS - 1;
+
+static uint32_t fakeBlock = 0;
+
+extern "C" {
+void* __real_malloc(size_t) { return (void*)(uintptr_t)fakeBlock; }
+void __real_free(void*) {}
+void* __real_realloc(void*, size_t) { return (void*)(uintptr_t)fakeBlock; }
+void* __real_calloc(size_t, size_t) { return (void*)(uintptr_t)fakeBlock; }
+}
+
+static void resetTrace() {
+  memset(slots, 0, sizeof(slots));
+  memset(tagStats, 0, sizeof(tagStats));
+  tracked = trackedPeak = 0;
+  untracked = 0;
+  currentTag = HT_OTHER;
+}
+
+/**
+ * The n-th 8-byte aligned address (from 0x3FFE8000) whose home slot is home
+ */
+static uint32_t addrWithHome(uint16_t home, uint8_t n) {
+  for (uint32_t a = 0x3FFE8000;; a += 8) {
+    if (slotOf(a) == home && n-- == 0) return a;
+  }
+}
+
+static void alloc(uint32_t addr, size_t size) {
+  fakeBlock = addr;
+  TEST_ASSERT_EQUAL(addr, (uint32_t)(uintptr_t)__wrap_malloc(size));
+}
+
+static void release(uint32_t addr) {
+  __wrap_free((void*)(uintptr_t)addr);
+}
+
+static int16_t slotHolding(uint32_t addr) {
+  for (uint16_t i = 0; i < HEAP_TRACE_SLOTS; i++) {
+    if (slots[i].ptr == addr) return i;
+  }
+  return -1;
+}
+
+static void test_collisions_probe_forward() {
+  resetTrace();
+  uint16_t h = 40;
+  uint32_t a = addrWithHome(h, 0), b = addrWithHome(h, 1), c = addrWithHome(h, 2);
+  alloc(a, 10);
+  alloc(b, 20);
+  alloc(c, 30);
+  TEST_ASSERT_EQUAL(h, slotHolding(a));
+  TEST_ASSERT_EQUAL(h + 1, slotHolding(b));
+  TEST_ASSERT_EQUAL(h + 2, slotHolding(c));
+  TEST_ASSERT_EQUAL(60, heapTraceStats(HT_OTHER).liveBytes);
+}
+
+static void test_delete_shifts_chain_back() {
+  resetTrace();
+  uint16_t h = 40;
+  uint32_t a = addrWithHome(h, 0), b = addrWithHome(h, 1);
+  uint32_t d = addrWithHome(h + 1, 0);    // Displaced by b to h + 2
+  uint32_t e = addrWithHome(h + 3, 0);    // At home - must not move
+  alloc(a, 1);
+  alloc(b, 2);
+  alloc(d, 4);
+  alloc(e, 8);
+  TEST_ASSERT_EQUAL(h + 2, slotHolding(d));
+
+  release(a);
+  TEST_ASSERT_EQUAL(h, slotHolding(b));
+  TEST_ASSERT_EQUAL(h + 1, slotHolding(d));
+  TEST_ASSERT_EQUAL(h + 3, slotHolding(e));
+  TEST_ASSERT_EQUAL(0, slots[h + 2].ptr);  // No tombstone
+
+  // Everything left is still reachable from its home
+  release(d);
+  release(b);
+  release(e);
+  TEST_ASSERT_EQUAL(0, tracked);
+  TEST_ASSERT_EQUAL(0, heapTraceStats(HT_OTHER).liveBytes);
+  TEST_ASSERT_EQUAL(4, heapTraceStats(HT_OTHER).frees);
+}
+
+static void test_delete_across_table_end() {
+  resetTrace();
+  uint16_t h = MASK;                      // Last slot, chain wraps to 0, 1
+  uint32_t a = addrWithHome(h, 0), b = addrWithHome(h, 1), c = addrWithHome(h, 2);
+  uint32_t z = addrWithHome(0, 0);        // Home 0, pushed to 2
+  alloc(a, 1);
+  alloc(b, 1);
+  alloc(z, 1);
+  alloc(c, 1);
+  TEST_ASSERT_EQUAL(0, slotHolding(b));
+  TEST_ASSERT_EQUAL(1, slotHolding(z));
+  TEST_ASSERT_EQUAL(2, slotHolding(c));
+
+  release(a);
+  TEST_ASSERT_EQUAL(h, slotHolding(b));
+  TEST_ASSERT_EQUAL(0, slotHolding(z));
+  TEST_ASSERT_EQUAL(1, slotHolding(c));
+  TEST_ASSERT_EQUAL(0, slots[2].ptr);
+}
+
+static void test_unknown_free_ignored() {
+  resetTrace();
+  alloc(addrWithHome(7, 0), 16);
+  release(addrWithHome(7, 1));            // Allocated before the trace started
+  release(0);
+  TEST_ASSERT_EQUAL(1, tracked);
+  TEST_ASSERT_EQUAL(16, heapTraceStats(HT_OTHER).liveBytes);
+}
+
+static void test_full_table_not_counted_live() {
+  resetTrace();
+  uint32_t a = 0x3FFE8000;
+  for (uint16_t i = 0; i < HEAP_TRACE_SLOTS - 1; i++, a += 8) alloc(a, 4);
+  uint32_t live = heapTraceStats(HT_OTHER).liveBytes;
+
+  alloc(a, 100);                          // No slot left
+  release(a);                             // ... so its free is not seen
+  TEST_ASSERT_EQUAL(1, untracked);
+  TEST_ASSERT_EQUAL(live, heapTraceStats(HT_OTHER).liveBytes);
+}
+
+static void test_scope_tags_allocations() {
+  resetTrace();
+  {
+    HEAP_SCOPE(HT_TX);
+    alloc(addrWithHome(3, 0), 50);
+  }
+  alloc(addrWithHome(3, 1), 5);
+  TEST_ASSERT_EQUAL(50, heapTraceStats(HT_TX).liveBytes);
+  TEST_ASSERT_EQUAL(5, heapTraceStats(HT_OTHER).liveBytes);
+
+  release(addrWithHome(3, 0));            // Charged back to its own tag
+  TEST_ASSERT_EQUAL(0, heapTraceStats(HT_TX).liveBytes);
+  TEST_ASSERT_EQUAL(5, heapTraceStats(HT_OTHER).liveBytes);
+}
+
+void runHeapTraceTests() {
+  RUN_TEST(test_collisions_probe_forward);
+  RUN_TEST(test_delete_shifts_chain_back);
+  RUN_TEST(test_delete_across_table_end);
+  RUN_TEST(test_unknown_free_ignored);
+  RUN_TEST(test_full_table_not_counted_live);
+  RUN_TEST(test_scope_tags_allocations);
+}
@@ -0,0 +1,195 @@
+// ============================================================================
+// test_logger.cpp - Tokenized Log Record Round Trip
+// ============================================================================
+// Records are taken from the Serial stand-in and decoded by the rules in
+// tools/log_decode.py: find 0xFF, check length and CRC-8, look the token
+// up, then rebuild the line by walking the format and reading one value
+// per conversion. The result must equal what snprintf() prints for the
+// same arguments, i.e. what a text build would have logged.
+// ============================================================================
+
+#include <unity.h>
+#define LOG_TOKENIZED
+#include "logger.cpp"
+
+// Drain is write-through until logBegin(), so the scheduler is never used
+void schedAfter(SchedTask&, const char*, SchedFn, uint32_t) {}
+
+struct Record {
+  uint32_t token;
+  uint8_t level;
+  const uint8_t* args;
+  const uint8_t* end;
+};
+
+static uint8_t crc8(const uint8_t* p, size_t n) {
+  uint8_t crc = 0;
+  while (n--) {
+    crc ^= *p++;
+    for (uint8_t b = 0; b < 8; b++) crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+  }
+  return crc;
+}
+
+/**
+ * Next record in the capture at or after pos (text before it is skipped)
+ */
+static bool nextRecord(size_t& pos, Record& r) {
+  while (pos < Serial.len && Serial.out[pos] != LOG_RECORD_MARK) pos++;
+  if (pos + 2 > Serial.len) return false;
+  const uint8_t* body = Serial.out + pos + 2;
+  uint8_t n = Serial.out[pos + 1];
+  if (n < 5 || pos + 3 + n > Serial.len || crc8(body, n) != body[n]) return false;
+  memcpy(&r.token, body, 4);
+  r.level = body[4];
+  r.args = body + 5;
+  r.end = body + n;
+  pos += 3 + n;
+  return true;
+}
+
+static uint64_t readVarint(const uint8_t*& p) {
+  uint64_t v = 0;
+  for (uint8_t shift = 0;; shift += 7) {
+    uint8_t b = *p++;
+    v |= (uint64_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return v;
+  }
+}
+
+static int64_t readInt(const uint8_t*& p) {
+  uint64_t v = readVarint(p);
+  return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+/**
+ * printf-style rebuild of the message from the record arguments
+ */
+static void formatRecord(const char* fmt, Record& r, char* out, size_t size) {
+  const uint8_t* p = r.args;
+  size_t n = 0;
+  while (*fmt && n + 1 < size) {
+    if (*fmt != '%') {
+      out[n++] = *fmt++;
+      continue;
+    }
+    char spec[16] = "%";
+    size_t s = 1;
+    fmt++;
+    while (strchr("-+ #0123456789.", *fmt)) spec[s++] = *fmt++;
+    while (strchr("hlzjt", *fmt)) fmt++;  // Widths come from the record
+    char conv = *fmt++;
+    int w = 0;
+    if (conv == '%') {
+      w = snprintf(out + n, size - n, "%%");
+    } else if (strchr("di", conv)) {
+      strcpy(spec + s, "lld");
+      w = snprintf(out + n, size - n, spec, (long long)readInt(p));
+    } else if (strchr("uxX", conv)) {
+      spec[s++] = 'l';
+      spec[s++] = 'l';
+      spec[s] = conv;
+      w = snprintf(out + n, size - n, spec, (unsigned long long)(readInt(p) & 0xFFFFFFFF));
+    } else if (conv == 'c') {
+      strcpy(spec + s, "c");
+      w = snprintf(out + n, size - n, spec, (int)readInt(p));
+    } else if (conv == 's') {
+      size_t len = readVarint(p);
+      char str[LOG_LINE_MAX];
+      memcpy(str, p, len);
+      str[len] = '\0';
+      p += len;
+      strcpy(spec + s, "s");
+      w = snprintf(out + n, size - n, spec, str);
+    } else {
+      float f;
+      memcpy(&f, p, 4);
+      p += 4;
+      spec[s] = conv;
+      w = snprintf(out + n, size - n, spec, (double)f);
+    }
+    n += (w > 0) ? (size_t)w : 0;
+    if (n >= size) n = size - 1;
+  }
+  out[n] = '\0';
+  TEST_ASSERT_TRUE(p == r.end);           // Every argument byte consumed
+}
+
+#define ROUND_TRIP(lvl, tag, fmt, ...)                                          \
+  do {                                                                          \
+    Serial.clear();                                                             \
+    LOG_AT(lvl, tag, fmt, ##__VA_ARGS__);                                       \
+    size_t pos = 0;                                                             \
+    Record r;                                                                   \
+    TEST_ASSERT_TRUE(nextRecord(pos, r));                                       \
+    TEST_ASSERT_EQUAL_HEX32(logToken(tag "\x1f" fmt), r.token);                 \
+    TEST_ASSERT_EQUAL(lvl, r.level);                                            \
+    char decoded[LOG_LINE_MAX], expected[LOG_LINE_MAX];                         \
+    formatRecord(fmt, r, decoded, sizeof(decoded));                             \
+    snprintf(expected, sizeof(expected), fmt, ##__VA_ARGS__);                   \
+    TEST_ASSERT_EQUAL_STRING(expected, decoded);                                \
+  } while (0)
+
+static void test_token_matches_decoder_hash() {
+  // FNV-1a of "NET\x1fup" - the value log_decode.py --table lists
+  TEST_ASSERT_EQUAL_HEX32(0xF4B48580u, logToken("NET\x1fup"));
+}
+
+static void test_round_trip_integers() {
+  ROUND_TRIP(LOG_INFO, "TEST", "n=%d u=%u x=%08lX c=%c", -5, 300u, 0xDEADBEEFUL, 'x');
+  ROUND_TRIP(LOG_WARN, "TEST", "min=%ld max=%lu", (long)INT32_MIN, (unsigned long)UINT32_MAX);
+  ROUND_TRIP(LOG_ERROR, "TEST", "%d%%", 100);
+}
+
+static void test_round_trip_floats_and_strings() {
+  ROUND_TRIP(LOG_INFO, "SENSOR", "%s = %.1f %s (z = %.2f)", "Lux", 412.5, "lx", -3.25);
+  ROUND_TRIP(LOG_DEBUG, "HTTP", "Reply: '%-6s'", "");
+  ROUND_TRIP(LOG_INFO, "UTF8", "%s", "22.5 \xC2\xB0" "C");
+}
+
+static void test_small_values_are_short() {
+  Serial.clear();
+  LOGI("T", "%d %d", 1, -1);
+  // Mark, length, token, level, two 1-byte varints, CRC
+  TEST_ASSERT_EQUAL(10, Serial.len);
+  TEST_ASSERT_EQUAL(0x02, Serial.out[7]);   // zigzag(1)
+  TEST_ASSERT_EQUAL(0x01, Serial.out[8]);   // zigzag(-1)
+}
+
+static void test_long_string_truncated_but_valid() {
+  char big[300];
+  memset(big, 'a', sizeof(big) - 1);
+  big[sizeof(big) - 1] = '\0';
+  uint32_t before = logStats().truncated;
+
+  Serial.clear();
+  LOGI("T", "%s %d", big, 7);
+  size_t pos = 0;
+  Record r;
+  TEST_ASSERT_TRUE(nextRecord(pos, r));   // CRC still right
+  TEST_ASSERT_TRUE(Serial.len <= LOG_LINE_MAX);
+  TEST_ASSERT_EQUAL(before + 1, logStats().truncated);
+}
+
+static void test_records_between_console_text() {
+  Serial.clear();
+  CONSOLE("banner\n");
+  LOGW("NET", "up");
+  CONSOLE("menu\n");
+  TEST_ASSERT_EQUAL_MEMORY("banner\n", Serial.out, 7);
+  size_t pos = 0;
+  Record r;
+  TEST_ASSERT_TRUE(nextRecord(pos, r));
+  TEST_ASSERT_EQUAL_HEX32(logToken("NET\x1fup"), r.token);
+  TEST_ASSERT_TRUE(r.args == r.end);
+  TEST_ASSERT_EQUAL_MEMORY("menu\n", Serial.out + pos, 5);
+}
+
+void runLoggerTests() {
+  RUN_TEST(test_token_matches_decoder_hash);
+  RUN_TEST(test_round_trip_integers);
+  RUN_TEST(test_round_trip_floats_and_strings);
+  RUN_TEST(test_small_values_are_short);
+  RUN_TEST(test_long_string_truncated_but_valid);
+  RUN_TEST(test_records_between_console_text);
+}
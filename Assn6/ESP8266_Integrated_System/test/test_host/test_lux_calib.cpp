@@ -0,0 +1,78 @@
+// ============================================================================
+// test_lux_calib.cpp - Generated Lux Table Against the Reference Points
+// ============================================================================
+// Works for any LUX_CAL_POINTS: expected values are worked out here in
+// floating point from the points, not copied from the table.
+// ============================================================================
+
+#include <unity.h>
+#include "lux_calib.cpp"
+
+static const uint8_t FRAC = 2;              // Oversampler<4> output in the light path
+
+/**
+ * Straight-line lux between the reference points around a (fractional) code
+ */
+static double expectedLux(double adc) {
+  if (adc <= LUX_CAL_POINTS[0].adc) return LUX_CAL_POINTS[0].lux;
+  for (uint8_t i = 1; i < LUX_CAL_COUNT; i++) {
+    const LuxCalPoint& a = LUX_CAL_POINTS[i - 1];
+    const LuxCalPoint& b = LUX_CAL_POINTS[i];
+    if (adc <= b.adc) return a.lux + ((double)b.lux - a.lux) * (adc - a.adc) / (b.adc - a.adc);
+  }
+  return LUX_CAL_POINTS[LUX_CAL_COUNT - 1].lux;
+}
+
+static void test_every_point_exact() {
+  for (uint8_t i = 0; i < LUX_CAL_COUNT; i++) {
+    const LuxCalPoint& p = LUX_CAL_POINTS[i];
+    TEST_ASSERT_EQUAL(p.lux, luxFromAdc(p.adc));
+    TEST_ASSERT_EQUAL(p.lux, luxFromAdcQ((int32_t)p.adc << FRAC, FRAC));
+    TEST_ASSERT_EQUAL(p.lux, luxFromAdcQ(p.adc, 0));
+  }
+}
+
+static void test_between_points_on_the_line() {
+  for (uint8_t i = 1; i < LUX_CAL_COUNT; i++) {
+    uint16_t lo = LUX_CAL_POINTS[i - 1].adc, hi = LUX_CAL_POINTS[i].adc;
+    // Quarter, middle and three-quarter marks, plus off-grid fractions
+    for (uint8_t k = 1; k < 4; k++) {
+      int32_t q = (((int32_t)lo << FRAC) * (4 - k) + ((int32_t)hi << FRAC) * k) / 4 + 3;
+      double want = expectedLux((double)q / (1 << FRAC));
+      // Table entries are rounded (0.5) and the fraction step truncated (< 1)
+      TEST_ASSERT_FLOAT_WITHIN(1.5, want, luxFromAdcQ(q, FRAC));
+    }
+  }
+}
+
+static void test_fraction_between_codes() {
+  uint16_t code = LUX_CAL_POINTS[0].adc + 1;
+  uint16_t a = luxFromAdc(code), b = luxFromAdc(code + 1);
+  int32_t half = ((int32_t)code << FRAC) + (1 << (FRAC - 1));
+  TEST_ASSERT_EQUAL(a + (((int32_t)b - a) >> 1), luxFromAdcQ(half, FRAC));
+}
+
+static void test_out_of_range_clamps() {
+  TEST_ASSERT_EQUAL(luxFromAdc(0), luxFromAdcQ(-100, FRAC));
+  TEST_ASSERT_EQUAL(luxFromAdc(LUX_LUT_SIZE - 1), luxFromAdcQ(5000L << FRAC, FRAC));
+  TEST_ASSERT_EQUAL(luxFromAdc(LUX_LUT_SIZE - 1), luxFromAdc(5000));
+}
+
+static void test_table_monotonic() {
+  // Points run the same way as the sensor (lux falls as the code rises)
+  bool falling = LUX_CAL_POINTS[LUX_CAL_COUNT - 1].lux <= LUX_CAL_POINTS[0].lux;
+  uint16_t last = luxFromAdcQ(0, FRAC);
+  for (int32_t q = 1; q < ((int32_t)LUX_LUT_SIZE << FRAC); q++) {
+    uint16_t lux = luxFromAdcQ(q, FRAC);
+    TEST_ASSERT_TRUE(falling ? lux <= last : lux >= last);
+    last = lux;
+  }
+}
+
+void runLuxCalibTests() {
+  RUN_TEST(test_every_point_exact);
+  RUN_TEST(test_between_points_on_the_line);
+  RUN_TEST(test_fraction_between_codes);
+  RUN_TEST(test_out_of_range_clamps);
+  RUN_TEST(test_table_monotonic);
+}
@@ -0,0 +1,35 @@
+// ============================================================================
+// test_host - Host Tests for the Hardware-Free Modules
+// ============================================================================
+// Run: pio test -e native
+// Each test_*.cpp compiles its unit in directly (the firmware sources are
+// not part of the native build) against the core stand-in in test/host:
+//   test_static_string  StringView search/slice/toInt, StringBuffer limits
+//   test_profile        LatencyHistogram buckets and percentiles
+//   test_heap_trace     pointer table probing and backward-shift delete
+//   test_logger         tokenized records: encode, then decode the way
+//                       tools/log_decode.py does and compare the text
+//   test_lux_calib      generated lux table against LUX_CAL_POINTS
+// ============================================================================
+
+#include <unity.h>
+
+void runStaticStringTests();
+void runProfileTests();
+void runHeapTraceTests();
+void runLoggerTests();
+void runLuxCalibTests();
+
+void setUp() {}
+
+void tearDown() {}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  runStaticStringTests();
+  runProfileTests();
+  runHeapTraceTests();
+  runLoggerTests();
+  runLuxCalibTests();
+  return UNITY_END();
+}
@@ -0,0 +1,76 @@
+// ============================================================================
+// test_profile.cpp - LatencyHistogram Bucket and Percentile Math
+// ============================================================================
+
+#include <unity.h>
+#include "profile.cpp"
+
+// The dump is not checked here; a real logger, when linked in, takes over
+__attribute__((weak)) void logConsole(const char*, ...) {}
+
+typedef LatencyHistogram H;
+
+static void test_buckets_exact_below_subs() {
+  for (uint32_t v = 0; v < H::SUBS; v++) {
+    TEST_ASSERT_EQUAL(v, H::bucketOf(v));
+    TEST_ASSERT_EQUAL(v, H::bucketUpper(v));
+  }
+  TEST_ASSERT_EQUAL(4, H::bucketOf(4));
+  TEST_ASSERT_EQUAL(7, H::bucketOf(7));
+  TEST_ASSERT_EQUAL(8, H::bucketOf(8));
+  TEST_ASSERT_EQUAL(9, H::bucketUpper(8));        // 8..9
+}
+
+static void test_buckets_cover_within_25_percent() {
+  uint8_t last = 0;
+  for (uint32_t v = 1; v < (1UL << (H::MAX_LOG2 + 1)); v += 1 + v / 64) {
+    uint8_t b = H::bucketOf(v);
+    TEST_ASSERT_TRUE(b < H::BUCKETS);
+    TEST_ASSERT_TRUE(b >= last);                  // Monotonic
+    uint32_t upper = H::bucketUpper(b);
+    TEST_ASSERT_TRUE(upper >= v);
+    TEST_ASSERT_TRUE(upper - v <= v / 4);
+    TEST_ASSERT_EQUAL(b, H::bucketOf(upper));     // Upper bound is in the bucket
+    last = b;
+  }
+  TEST_ASSERT_EQUAL(H::BUCKETS - 1, H::bucketOf(0xFFFFFFFF));   // Clamped
+}
+
+static void test_percentiles() {
+  static H h;
+  h.reset();
+  TEST_ASSERT_EQUAL(0, h.percentile(50));
+
+  for (uint32_t v = 1; v <= 100; v++) h.record(v);
+  TEST_ASSERT_EQUAL(100, h.samples());
+  TEST_ASSERT_EQUAL(100, h.max());
+  TEST_ASSERT_EQUAL(55, h.percentile(50));        // 50 lies in 48..55
+  TEST_ASSERT_EQUAL(95, h.percentile(90));        // 88..95
+  TEST_ASSERT_EQUAL(100, h.percentile(99));       // 96..111, capped at max
+  TEST_ASSERT_EQUAL(1, h.percentile(0));
+}
+
+static void test_saturation_keeps_shape() {
+  static H h;
+  h.reset();
+  for (uint32_t i = 0; i < 0x20000; i++) h.record(i & 1 ? 10 : 1000);   // Halves once
+  TEST_ASSERT_EQUAL(0x20000, h.samples());
+  TEST_ASSERT_EQUAL(11, h.percentile(50));
+  TEST_ASSERT_EQUAL(1000, h.percentile(51));
+}
+
+static void test_record_cycles() {
+  static H h;
+  h.reset();
+  profileCyclesPerUs = 80;
+  h.recordCycles(8000);
+  TEST_ASSERT_EQUAL(100, h.max());
+}
+
+void runProfileTests() {
+  RUN_TEST(test_buckets_exact_below_subs);
+  RUN_TEST(test_buckets_cover_within_25_percent);
+  RUN_TEST(test_percentiles);
+  RUN_TEST(test_saturation_keeps_shape);
+  RUN_TEST(test_record_cycles);
+}
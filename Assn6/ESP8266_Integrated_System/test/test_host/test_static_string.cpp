@@ -0,0 +1,94 @@
+// ============================================================================
+// test_static_string.cpp - StringView / StringBuffer
+// ============================================================================
+
+#include <unity.h>
+#include "static_string.cpp"
+
+static void test_view_index_of() {
+  StringView v("GET /led?state=on HTTP/1.1");
+  TEST_ASSERT_EQUAL(3, v.indexOf(' '));
+  TEST_ASSERT_EQUAL(17, v.indexOf(' ', 4));
+  TEST_ASSERT_EQUAL(9, v.indexOf("state="));
+  TEST_ASSERT_EQUAL(9, v.indexOfIgnoreCase("STATE="));
+  TEST_ASSERT_TRUE(v.indexOf("state=", 10) == StringView::npos);
+  TEST_ASSERT_TRUE(v.indexOf('#') == StringView::npos);
+  TEST_ASSERT_TRUE(v.indexOf('G', 100) == StringView::npos);
+  TEST_ASSERT_EQUAL(5, v.indexOf("", 5));
+
+  // Needle running past the end of the view, not just the text
+  StringView cut(v.data(), 12);
+  TEST_ASSERT_TRUE(cut.indexOf("state=") == StringView::npos);
+}
+
+static void test_view_substr_clamps() {
+  StringView v("abcdef");
+  TEST_ASSERT_TRUE(v.substr(2, 3) == "cde");
+  TEST_ASSERT_TRUE(v.substr(4) == "ef");
+  TEST_ASSERT_TRUE(v.substr(4, 100) == "ef");
+  TEST_ASSERT_TRUE(v.substr(6).empty());
+  TEST_ASSERT_TRUE(v.substr(50).empty());
+  TEST_ASSERT_TRUE(StringView("  on \r\n").trim() == "on");
+  TEST_ASSERT_TRUE(v.startsWith("abc"));
+  TEST_ASSERT_FALSE(v.startsWith("abcdefg"));
+}
+
+static void test_view_to_int() {
+  TEST_ASSERT_EQUAL(-42, StringView("  -42abc").toInt());
+  TEST_ASSERT_EQUAL(7, StringView("+7").toInt());
+  TEST_ASSERT_EQUAL(0, StringView("abc").toInt());
+  TEST_ASSERT_EQUAL(0, StringView("").toInt());
+  TEST_ASSERT_EQUAL(123, StringView("12345", 3).toInt());   // Stops at the view end
+}
+
+static void test_buffer_truncates() {
+  StaticString<8> s;
+  TEST_ASSERT_EQUAL(7, s.capacity());
+  TEST_ASSERT_TRUE(s.append("abcdef"));
+  TEST_ASSERT_FALSE(s.append("xyz"));
+  TEST_ASSERT_TRUE(s.truncated());
+  TEST_ASSERT_EQUAL_STRING("abcdefx", s.c_str());
+  TEST_ASSERT_FALSE(s.append('!'));
+  TEST_ASSERT_EQUAL(7, s.length());
+
+  s = "ok";
+  TEST_ASSERT_FALSE(s.truncated());
+  s.truncate(1);
+  TEST_ASSERT_EQUAL_STRING("o", s.c_str());
+}
+
+static void test_buffer_assign_from_own_slice() {
+  StaticString<16> s("key=value");
+  s = s.view().substr(4);
+  TEST_ASSERT_EQUAL_STRING("value", s.c_str());
+}
+
+static void test_buffer_appendf() {
+  StaticString<16> s("t=");
+  TEST_ASSERT_TRUE(s.appendf("%d.%u", -3, 5u));
+  TEST_ASSERT_EQUAL_STRING("t=-3.5", s.c_str());
+
+  StaticString<10> cut("val=");
+  TEST_ASSERT_FALSE(cut.appendf("%d", 123456789));
+  TEST_ASSERT_TRUE(cut.truncated());
+  TEST_ASSERT_EQUAL(9, cut.length());
+  TEST_ASSERT_EQUAL_STRING("val=12345", cut.c_str());
+}
+
+static void test_sink_claims_full_write() {
+  StaticString<4> s;
+  StringSink sink(s);
+  TEST_ASSERT_EQUAL(6, sink.write((const uint8_t*)"abcdef", 6));
+  TEST_ASSERT_EQUAL_STRING("abc", s.c_str());
+  TEST_ASSERT_TRUE(s.truncated());
+}
+
+void runStaticStringTests() {
+  RUN_TEST(test_view_index_of);
+  RUN_TEST(test_view_substr_clamps);
+  RUN_TEST(test_view_to_int);
+  RUN_TEST(test_buffer_truncates);
+  RUN_TEST(test_buffer_assign_from_own_slice);
+  RUN_TEST(test_buffer_appendf);
+  RUN_TEST(test_sink_claims_full_write);
+}
@@ -3,13 +3,16 @@
 // ============================================================================
 // Purpose: NTP time synchronization interface declarations
 // Functions: NTP configuration, ISO 8601 timestamp retrieval, timezone mgmt
-// Features: Lazy initialization, EEPROM timezone storage
+// Features: Lazy initialization, KV store timezone storage
 // ============================================================================
 
 #pragma once
 #include <Arduino.h>
+#include "static_string.h"
+
+typedef StaticString<32> IsoTimestamp;   // "2025-10-17T22:30:45-07:00"
 
 void timeClientBegin();
-bool readTimeISO(String& iso8601);
-String getTimezone();
-bool setTimezone(const String& tz);
\ No newline at end of file
+bool readTimeISO(StringBuffer& iso8601);
+const char* getTimezone();
+bool setTimezone(StringView tz);
\ No newline at end of file
@@ -0,0 +1,302 @@
+#!/usr/bin/env python3
+# ============================================================================
+# log_decode.py - Host Decoder for Tokenized Logging (-D LOG_TOKENIZED)
+# ============================================================================
+# Purpose: Turn the binary log records of a tokenized build back into the
+#          "[TAG] message" lines a text build prints
+# Method: The token table is rebuilt from the firmware sources - every
+#         LOGE/LOGW/LOGI/LOGD("TAG", "format", ...) call, hashed exactly as
+#         logToken() in logger.h does. Decode with the sources the firmware
+#         was built from. Text between records (CONSOLE output, boot banner)
+#         passes through unchanged.
+# Usage:
+#   log_decode.py capture.bin        decode a raw capture ('-' = stdin)
+#   log_decode.py --port COM3        read the board directly (needs pyserial)
+#   log_decode.py --table            list tokens, fail on hash collisions
+# Test: python3 test/log_decode/test_log_decode.py (round trip through the
+#       real encoder)
+# ============================================================================
+
+import argparse
+import codecs
+import os
+import re
+import struct
+import sys
+
+RECORD_MARK = 0xFF
+LEVEL_NAMES = {1: "E", 2: "W", 3: "I", 4: "D"}
+SOURCE_EXTS = (".cpp", ".h", ".c", ".ino")
+
+CALL_RE = re.compile(rb"\bLOG[EWID]\s*\(")
+SPEC_RE = re.compile(r"%([-+ #0]*)(\d+)?(?:\.(\d+))?(hh|h|ll|l|z|j|t|L)?([diouxXeEfFgGcsp%])")
+
+
+def log_token(tag, fmt):
+    """FNV-1a over tag, 0x1F, format - same as logToken() in logger.h"""
+    h = 2166136261
+    for b in tag + b"\x1f" + fmt:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+# ==== Source scanning ====
+
+def skip_space(src, i):
+    while i < len(src):
+        if src[i:i + 1].isspace():
+            i += 1
+        elif src.startswith(b"//", i):
+            i = src.find(b"\n", i)
+            i = len(src) if i < 0 else i
+        elif src.startswith(b"/*", i):
+            i = src.find(b"*/", i)
+            i = len(src) if i < 0 else i + 2
+        else:
+            break
+    return i
+
+
+def read_literal(src, i):
+    """One "..." literal at src[i] -> (bytes, end) with escapes applied"""
+    out = bytearray()
+    i += 1
+    while i < len(src) and src[i] != ord('"'):
+        c = src[i]
+        if c != ord("\\"):
+            out.append(c)
+            i += 1
+            continue
+        e = chr(src[i + 1])
+        i += 2
+        if e == "x":
+            j = i
+            while j < len(src) and chr(src[j]) in "0123456789abcdefABCDEF":
+                j += 1
+            out.append(int(src[i:j], 16) & 0xFF)
+            i = j
+        elif e in "01234567":
+            j = i
+            while j < len(src) and j < i + 2 and chr(src[j]) in "01234567":
+                j += 1
+            out.append(int(e + src[i:j].decode(), 8) & 0xFF)
+            i = j
+        else:
+            out += {"n": b"\n", "t": b"\t", "r": b"\r", "a": b"\a", "b": b"\b",
+                    "f": b"\f", "v": b"\v"}.get(e, e.encode())
+    return bytes(out), i + 1
+
+
+def read_string(src, i):
+    """Adjacent literals ("a" "b") -> (bytes, end), or (None, i)"""
+    i = skip_space(src, i)
+    if i >= len(src) or src[i] != ord('"'):
+        return None, i
+    out = b""
+    while i < len(src) and src[i] == ord('"'):
+        part, i = read_literal(src, i)
+        out += part
+        i = skip_space(src, i)
+    return out, i
+
+
+def scan_sources(root):
+    """token -> list of (tag, fmt, where)"""
+    table = {}
+    for dirpath, dirnames, filenames in os.walk(root):
+        dirnames[:] = [d for d in dirnames if not d.startswith(".")]
+        for name in sorted(filenames):
+            if not name.endswith(SOURCE_EXTS):
+                continue
+            path = os.path.join(dirpath, name)
+            with open(path, "rb") as f:
+                src = f.read()
+            for m in CALL_RE.finditer(src):
+                tag, i = read_string(src, m.end())
+                if tag is None or src[i:i + 1] != b",":
+                    continue                # Macro definitions, comments
+                fmt, i = read_string(src, i + 1)
+                if fmt is None:
+                    continue
+                line = src.count(b"\n", 0, m.start()) + 1
+                where = "%s:%d" % (os.path.relpath(path, root), line)
+                table.setdefault(log_token(tag, fmt), []).append((tag, fmt, where))
+    return table
+
+
+# ==== Record decoding ====
+
+class Args:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def varint(self):
+        v = shift = 0
+        while True:
+            b = self.data[self.pos]
+            self.pos += 1
+            v |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                return v
+
+    def int(self):
+        v = self.varint()
+        return (v >> 1) ^ -(v & 1)
+
+    def float(self):
+        if self.pos + 4 > len(self.data):
+            raise IndexError
+        v = struct.unpack_from("<f", self.data, self.pos)[0]
+        self.pos += 4
+        return v
+
+    def string(self):
+        n = self.varint()
+        if self.pos + n > len(self.data):
+            raise IndexError
+        s = self.data[self.pos:self.pos + n].decode("utf-8", "replace")
+        self.pos += n
+        return s
+
+
+def format_record(fmt, args):
+    """printf-style formatting, arguments read from the record as needed"""
+    out = []
+    last = 0
+    for m in SPEC_RE.finditer(fmt):
+        out.append(fmt[last:m.start()])
+        last = m.end()
+        flags, width, prec, _, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        spec = "%" + flags + (width or "") + ("." + prec if prec else "")
+        try:
+            if conv in "di":
+                out.append((spec + "d") % args.int())
+            elif conv in "uoxX":
+                out.append((spec + conv.replace("u", "d")) % (args.int() & 0xFFFFFFFF))
+            elif conv == "c":
+                out.append((spec + "c") % chr(args.int() & 0xFF))
+            elif conv == "p":
+                out.append((spec + "s") % ("0x%08x" % (args.int() & 0xFFFFFFFF)))
+            elif conv == "s":
+                out.append((spec + "s") % args.string())
+            else:
+                out.append((spec + conv) % args.float())
+        except IndexError:
+            out.append("?")                 # Cut off on the device (truncated)
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+class Decoder:
+    def __init__(self, table, out, levels=False):
+        self.table = table
+        self.out = out
+        self.levels = levels
+        self.buf = bytearray()
+        self.bad = 0
+        self.utf8 = codecs.getincrementaldecoder("utf-8")("replace")   # Text split across reads
+
+    def feed(self, data):
+        self.buf += data
+        while self.buf:
+            mark = self.buf.find(RECORD_MARK)
+            if mark < 0:
+                self.text(self.buf)
+                self.buf.clear()
+                return
+            if mark:
+                self.text(self.buf[:mark])
+                del self.buf[:mark]
+            if len(self.buf) < 2 or len(self.buf) < self.buf[1] + 3:
+                return                      # Wait for the rest
+            n = self.buf[1]
+            body = bytes(self.buf[2:2 + n])
+            if n < 5 or crc8(body) != self.buf[2 + n]:
+                self.bad += 1               # Started mid-record or line noise
+                del self.buf[:1]
+                continue
+            del self.buf[:n + 3]
+            self.record(body)
+
+    def text(self, data):
+        self.out.write(self.utf8.decode(bytes(data)))
+        self.out.flush()
+
+    def record(self, body):
+        token, level = struct.unpack_from("<IB", body)
+        prefix = LEVEL_NAMES.get(level, "?") + " " if self.levels else ""
+        entries = self.table.get(token)
+        if not entries:
+            self.out.write("%s[?] unknown token 0x%08X (%d argument bytes) - "
+                           "sources differ from the firmware?\n" % (prefix, token, len(body) - 5))
+        else:
+            tag, fmt, _ = entries[0]
+            msg = format_record(fmt.decode("utf-8", "replace"), Args(body[5:]))
+            self.out.write("%s[%s] %s\n" % (prefix, tag.decode("utf-8", "replace"), msg))
+        self.out.flush()
+
+
+def print_table(table):
+    collisions = 0
+    for token in sorted(table):
+        texts = {(tag, fmt) for tag, fmt, _ in table[token]}
+        if len(texts) > 1:
+            collisions += 1
+        for tag, fmt, where in table[token]:
+            print("%08X  %-28s [%s] %s%s" % (token, where, tag.decode("utf-8", "replace"),
+                                             fmt.decode("utf-8", "replace").encode("unicode_escape").decode(),
+                                             "  <-- COLLISION" if len(texts) > 1 else ""))
+    print("%d tokens, %d collisions" % (len(table), collisions))
+    return 1 if collisions else 0
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    ap = argparse.ArgumentParser(description="Decode tokenized ESP8266 log output")
+    ap.add_argument("input", nargs="?", default="-", help="raw capture file ('-' = stdin)")
+    ap.add_argument("--src", default=os.path.dirname(here), help="firmware source directory")
+    ap.add_argument("--port", help="serial port to read instead of a file")
+    ap.add_argument("--baud", type=int, default=9600)
+    ap.add_argument("--levels", action="store_true", help="prefix lines with E/W/I/D")
+    ap.add_argument("--table", action="store_true", help="print the token table and exit")
+    opts = ap.parse_args()
+
+    table = scan_sources(opts.src)
+    if opts.table:
+        return print_table(table)
+
+    dec = Decoder(table, sys.stdout, opts.levels)
+    try:
+        if opts.port:
+            import serial                   # pyserial
+            with serial.Serial(opts.port, opts.baud, timeout=0.1) as port:
+                while True:
+                    dec.feed(port.read(256))
+        else:
+            f = sys.stdin.buffer if opts.input == "-" else open(opts.input, "rb")
+            with f:
+                for chunk in iter(lambda: f.read(4096), b""):
+                    dec.feed(chunk)
+    except KeyboardInterrupt:
+        pass
+    if dec.bad:
+        sys.stderr.write("%d bytes skipped (bad records)\n" % dec.bad)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,95 +1,162 @@
 #include "tx.h"
 #include "config.h"
+#include "logger.h"
 #include "net.h"
+#include "report.h"
+#include "heap_trace.h"
+#include "static_string.h"
+#include "mem_pool.h"
 
 #include <ESP8266HTTPClient.h>
 #include <WiFiClientSecureBearSSL.h>
 #include <ArduinoJson.h>
 
-// Simple URL encoding for timestamp
-static String urlEncode(const String& str) {
-  String encoded = "";
-  char c;
+// Simple URL encoding for timestamp (appended to out)
+static void urlEncode(StringView str, StringBuffer& out) {
+  static const char hex[] = "0123456789ABCDEF";
   for (size_t i = 0; i < str.length(); i++) {
-    c = str.charAt(i);
+    uint8_t c = str[i];
     if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
-      encoded += c;
+      out.append((char)c);
     } else if (c == ' ') {
-      encoded += '+';
+      out.append('+');
     } else {
-      encoded += '%';
-      char hex[3];
-      sprintf(hex, "%02X", c);
-      encoded += hex;
+      out.append('%');
+      out.append(hex[c >> 4]);
+      out.append(hex[c & 0x0F]);
     }
   }
-  return encoded;
 }
 
-// Hash function to detect duplicate transmissions
-static uint32_t simpleHash(const String& s) {
-  uint32_t h = 2166136261u;
-  for (size_t i = 0; i < s.length(); i++) {
-    h ^= (uint8_t)s[i];
-    h *= 16777619u;
-  }
-  return h;
+/**
+ * "<key><suffix>" in out, for summary field names
+ */
+static const char* fieldName(StringBuffer& out, const char* key, const char* suffix) {
+  out.assign(key);
+  out.append(suffix);
+  return out.c_str();
 }
 
-bool transmit(uint8_t node, const String& iso, float tC, float h,
-              uint32_t activityCount) {
-  ensureWiFi();
-  if (!isWiFiUp()) {
-    Serial.println("[TX] Error: No WiFi connection (-20)");
+/**
+ * HTTPS POST of a finished payload to the database endpoint
+ */
+static bool postPayload(uint8_t node, const char* iso, const StringBuffer& payload) {
+  LOGD("TX", "Payload: %s", payload.c_str());
+  if (payload.truncated()) {
+    LOGE("TX", "Payload exceeds TX_PAYLOAD_MAX");
     return false;
   }
 
-  // Build JSON payload
-  JsonDocument body;
-  body["node"] = node;
-  body["temperature_C"] = tC;
-  body["humidity_pct"] = h;
-  body["timestamp"] = iso;
-  body["activity_count"] = activityCount;
-
-  String payload;
-  serializeJson(body, payload);
-
-  // Check for duplicate transmission
-  static uint32_t lastHash[3] = {0, 0, 0};
-  uint32_t hsh = simpleHash(payload);
-  if (node < 3 && lastHash[node] == hsh) {
-    Serial.println("[TX] Duplicate payload -> skipped");
+  // Send HTTPS POST
+  std::unique_ptr<BearSSL::WiFiClientSecure, PoolDeleter> client(
+      poolNew<BearSSL::WiFiClientSecure>());
+  if (!client) {
+    LOGE("TX", "Out of memory for TLS client");
     return false;
   }
-
-  // Send HTTPS POST
-  std::unique_ptr<BearSSL::WiFiClientSecure> client(new BearSSL::WiFiClientSecure());
   client->setInsecure();
+  client->setTimeout(15000);
 
   HTTPClient http;
-  String url = String(DB_BASE_URL) + "?ts=" + urlEncode(iso) + "&node=" + String(node);
+  http.setTimeout(15000);
+  http.setReuse(false);
+  StaticString<URL_MAX> url = DB_BASE_URL "?ts=";
+  urlEncode(iso, url);
+  url.appendf("&node=%u", node);
   
-  if (!http.begin(*client, url)) {
-    Serial.println("[TX] Error: HTTP begin failed (-21)");
+  if (!http.begin(*client, url.c_str())) {
+    LOGE("TX", "HTTP begin failed (-21)");
     return false;
   }
 
   http.addHeader("Content-Type", "application/json");
-  int code = http.POST(payload);
-  String response = http.getString();
+  int code = http.POST((const uint8_t*)payload.c_str(), payload.length());
+  PoolString response(HTTP_REPLY_MAX);
+  StringSink sink(response);
+  if (code > 0) http.writeToStream(&sink);
   http.end();
 
   if (code == HTTP_CODE_OK || code == HTTP_CODE_ACCEPTED || code == HTTP_CODE_CREATED) {
-    Serial.print("[TX] Success: ");
-    Serial.println(code);
-    if (node < 3) lastHash[node] = hsh;
+    LOGI("TX", "Success: %d", code);
+    LOGD("TX", "Response: %s", response.c_str());
     return true;
   }
 
-  Serial.print("[TX] Error: POST failed, code: ");
-  Serial.println(code);
-  Serial.print("[TX] Response: ");
-  Serial.println(response);
+  LOGE("TX", "POST failed, code: %d", code);
+  LOGW("TX", "Response: %s", response.c_str());
   return false;
 }
+
+bool transmit(uint8_t node, const char* iso, const SensorReading& reading,
+              uint32_t activityCount) {
+  HEAP_SCOPE(HT_TX);
+  if (!ensureWiFi()) {
+    LOGE("TX", "No WiFi connection (-20)");
+    return false;
+  }
+
+  // Build JSON payload - one field per valid channel
+  JsonDocument body(&jsonPool);
+  body["node"] = node;
+  for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+    if (reading.has((SensorChannel)ch)) {
+      body[channelInfo((SensorChannel)ch).jsonKey] = reading.value[ch];
+    }
+  }
+  body["timestamp"] = iso;
+  body["activity_count"] = activityCount;
+
+  PoolString payload(TX_PAYLOAD_MAX);
+  serializeJson(body, payload);
+
+  // On-demand readings are always sent; they become the new deadband reference
+  if (!postPayload(node, iso, payload)) return false;
+  reportSent(reading.value, reading.validMask);
+  return true;
+}
+
+bool transmitSummary(uint8_t node, const char* iso, const WindowSummary& summary,
+                     uint32_t activityCount) {
+  HEAP_SCOPE(HT_TX);
+  // Report by exception - skip windows whose means stayed inside the deadbands
+  float means[CH_COUNT];
+  uint32_t mask = 0;
+  for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+    means[ch] = summary.ch[ch].mean;
+    if (summary.ch[ch].count) mask |= (1UL << ch);
+  }
+  if (!reportDue(means, mask)) {
+    LOGI("TX", "Inside deadband -> suppressed");
+    return true;
+  }
+
+  if (!ensureWiFi()) {
+    LOGE("TX", "No WiFi connection (-20)");
+    return false;
+  }
+
+  // Mean goes under the plain channel key so the dashboard keeps plotting it;
+  // spread and sample count ride along as <key>_min/_max/_std/_n
+  JsonDocument body(&jsonPool);
+  body["node"] = node;
+  for (uint8_t ch = 0; ch < CH_COUNT; ch++) {
+    const ChannelStats& st = summary.ch[ch];
+    if (st.count == 0) continue;
+    const char* key = channelInfo((SensorChannel)ch).jsonKey;
+    StaticString<32> field;
+    body[key] = st.mean;
+    body[fieldName(field, key, "_min")] = st.min;
+    body[fieldName(field, key, "_max")] = st.max;
+    body[fieldName(field, key, "_std")] = st.stddev();
+    body[fieldName(field, key, "_n")] = st.count;
+  }
+  body["window_s"] = summary.windowMs / 1000;
+  body["timestamp"] = iso;
+  body["activity_count"] = activityCount;
+
+  PoolString payload(TX_PAYLOAD_MAX);
+  serializeJson(body, payload);
+  if (!postPayload(node, iso, payload)) return false;
+  reportSent(means, mask);
+  return true;
+}
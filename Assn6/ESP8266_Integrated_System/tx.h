@@ -3,11 +3,20 @@
 // ============================================================================
 // Purpose: Data transmission interface declarations
 // Function: transmit() - Send sensor data to backend via HTTPS
+//           transmitSummary() - Send one aggregation window (aggregate.h)
 // Protocol: JSON payload over HTTPS POST request
+// Payload: One field per valid channel of the reading (see sensors.cpp);
+//          summaries add <key>_min/_max/_std/_n and window_s
+// Suppression: summaries are reported by exception (report.h)
 // ============================================================================
 
 #pragma once
 #include <Arduino.h>
+#include "sensors.h"
+#include "aggregate.h"
 
-bool transmit(uint8_t node, const String& iso8601, float tC, float h,
-              uint32_t activityCount);
\ No newline at end of file
+bool transmit(uint8_t node, const char* iso8601, const SensorReading& reading,
+              uint32_t activityCount);
+
+bool transmitSummary(uint8_t node, const char* iso8601, const WindowSummary& summary,
+                     uint32_t activityCount);
\ No newline at end of file